@@ -0,0 +1,76 @@
+/*!
+ *  @file Adafruit_PWMBatch.cpp
+ *
+ *  The driver keeps a pointer to the active guard and hands it every
+ *  channel write; the guard keeps the last value per channel. Committing
+ *  detaches the guard first so its own bursts go to the bus. Not built
+ *  with PCA9685_NO_BATCH.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMServoDriver.h"
+
+#ifndef PCA9685_NO_BATCH
+
+/*!
+ *  @brief  Starts collecting the writes of a driver
+ *  @param  pwm The driver, NULL for an inactive guard
+ */
+Adafruit_PWMBatch::Adafruit_PWMBatch(Adafruit_PWMServoDriver *pwm)
+    : _pwm(pwm), _mask(0) {
+  if (_pwm)
+    _pwm->_batch = this;
+}
+
+/*!
+ *  @brief  Takes over a batch, so that beginBatch() can return the guard
+ * by value
+ *  @param  other The guard to take over, left inactive
+ */
+Adafruit_PWMBatch::Adafruit_PWMBatch(Adafruit_PWMBatch &&other)
+    : _pwm(other._pwm), _mask(other._mask) {
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    _on[num] = other._on[num];
+    _off[num] = other._off[num];
+  }
+  other._pwm = NULL;
+  other._mask = 0;
+  if (_pwm)
+    _pwm->_batch = this;
+}
+
+/*!
+ *  @brief  Sends the collected writes, if not committed yet
+ */
+Adafruit_PWMBatch::~Adafruit_PWMBatch() { commit(); }
+
+/*!
+ *  @brief  Ends the batch and sends the collected writes, one burst per run
+ * of consecutive channels. Later writes go straight to the chip
+ *  @return success of all i2c writes, true if there was nothing to send
+ */
+bool Adafruit_PWMBatch::commit() {
+  if (!_pwm)
+    return true;
+  Adafruit_PWMServoDriver *pwm = _pwm;
+  pwm->_batch = NULL;
+  _pwm = NULL;
+  uint16_t mask = _mask;
+  _mask = 0;
+  return pwm->writeRuns(mask, _on, _off);
+}
+
+/*!
+ *  @brief  Records a channel write, replacing an earlier one
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  on ON tick value
+ *  @param  off OFF tick value
+ */
+void Adafruit_PWMBatch::set(uint8_t num, uint16_t on, uint16_t off) {
+  _on[num] = on;
+  _off[num] = off;
+  _mask |= 1U << num;
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*!
+ *  @file Adafruit_PWMBatch.h
+ *
+ *  Scope guard returned by Adafruit_PWMServoDriver::beginBatch(). While it
+ *  is alive, setPWM(), setPin(), writeMicroseconds() and the burst writes
+ *  of the driver only record the new channel values; they are sent in one
+ *  burst per run of changed channels when the guard is committed or goes
+ *  out of scope. Included by Adafruit_PWMServoDriver.h.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMBatch_H
+#define _ADAFRUIT_PWMBatch_H
+
+class Adafruit_PWMServoDriver;
+
+/*!
+ *  @brief  Class that collects the channel writes of one driver and sends
+ * them together
+ */
+class Adafruit_PWMBatch {
+public:
+  Adafruit_PWMBatch(Adafruit_PWMBatch &&other);
+  ~Adafruit_PWMBatch();
+
+  bool commit();
+
+  /*!
+   *  @brief  Whether writes are being collected by this guard, false for
+   * a nested batch, which leaves the writes to the outer one
+   *  @return true until committed
+   */
+  bool active() const { return _pwm != NULL; }
+
+  /*!
+   *  @brief  Channels written since the batch began
+   *  @return one bit per channel, bit 0 is channel 0
+   */
+  uint16_t pendingMask() const { return _mask; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+
+  Adafruit_PWMBatch(Adafruit_PWMServoDriver *pwm);
+  void set(uint8_t num, uint16_t on, uint16_t off);
+
+  Adafruit_PWMServoDriver *_pwm; // NULL once committed or when nested
+  uint16_t _mask;
+  uint16_t _on[PCA9685_NUM_CHANNELS];
+  uint16_t _off[PCA9685_NUM_CHANNELS];
+};
+
+#endif
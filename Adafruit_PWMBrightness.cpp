@@ -0,0 +1,63 @@
+/*!
+ *  @file Adafruit_PWMBrightness.cpp
+ *
+ *  Master and group brightness levels. Changing a level only bumps a
+ *  counter, every frame using these levels recomputes its outputs on its
+ *  next flush and sends the channels whose output actually changed.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMBrightness.h"
+
+/*!
+ *  @brief  Instantiates brightness levels, all at full brightness
+ */
+Adafruit_PWMBrightness::Adafruit_PWMBrightness()
+    : _master(PWM_BRIGHTNESS_FULL), _generation(0) {
+  for (uint8_t i = 0; i < PWM_BRIGHTNESS_GROUPS; i++)
+    _group[i] = PWM_BRIGHTNESS_FULL;
+}
+
+/*!
+ *  @brief  Sets the master level applied to every group
+ *  @param  level Level, from 0 (off) to PWM_BRIGHTNESS_FULL
+ */
+void Adafruit_PWMBrightness::setMaster(uint16_t level) {
+  if (_master == level)
+    return;
+  _master = level;
+  _generation++;
+}
+
+/*!
+ *  @brief  Sets the level of one group
+ *  @param  group Group number, below PWM_BRIGHTNESS_GROUPS
+ *  @param  level Level, from 0 (off) to PWM_BRIGHTNESS_FULL
+ */
+void Adafruit_PWMBrightness::setGroup(uint8_t group, uint16_t level) {
+  if (group >= PWM_BRIGHTNESS_GROUPS || _group[group] == level)
+    return;
+  _group[group] = level;
+  _generation++;
+}
+
+/*!
+ *  @brief  Gets the level of one group
+ *  @param  group Group number, below PWM_BRIGHTNESS_GROUPS
+ *  @return level, PWM_BRIGHTNESS_FULL for unknown groups
+ */
+uint16_t Adafruit_PWMBrightness::getGroup(uint8_t group) const {
+  return group < PWM_BRIGHTNESS_GROUPS ? _group[group] : PWM_BRIGHTNESS_FULL;
+}
+
+/*!
+ *  @brief  Gets the effective level of a group, master included
+ *  @param  group Group number, PWM_GROUP_NONE never dims
+ *  @return combined level
+ */
+uint16_t Adafruit_PWMBrightness::level(uint8_t group) const {
+  if (group == PWM_GROUP_NONE)
+    return PWM_BRIGHTNESS_FULL;
+  return scale(_master, getGroup(group));
+}
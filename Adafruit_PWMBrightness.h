@@ -0,0 +1,58 @@
+/*!
+ *  @file Adafruit_PWMBrightness.h
+ *
+ *  Master and group brightness levels shared by any number of frames.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMBrightness_H
+#define _ADAFRUIT_PWMBrightness_H
+
+#include <Arduino.h>
+
+#define PWM_BRIGHTNESS_FULL 0xFFFF /**< Level that leaves outputs unchanged */
+#define PWM_BRIGHTNESS_GROUPS 8    /**< Number of brightness groups */
+#define PWM_GROUP_NONE 0xFF        /**< Group of channels that never dim */
+
+/*!
+ *  @brief  Class that stores a master level and per-group levels, applied
+ * by frames when they flush
+ */
+class Adafruit_PWMBrightness {
+public:
+  Adafruit_PWMBrightness();
+
+  void setMaster(uint16_t level);
+  /*!
+   *  @brief  Gets the master level
+   *  @return level, PWM_BRIGHTNESS_FULL is full brightness
+   */
+  uint16_t getMaster() const { return _master; }
+  void setGroup(uint8_t group, uint16_t level);
+  uint16_t getGroup(uint8_t group) const;
+  uint16_t level(uint8_t group) const;
+
+  /*!
+   *  @brief  Counter bumped on every level change, so frames can tell when
+   * their outputs must be recomputed
+   *  @return change counter
+   */
+  uint16_t generation() const { return _generation; }
+
+  /*!
+   *  @brief  Multiplies two levels, PWM_BRIGHTNESS_FULL being 1.0
+   *  @param  a First level
+   *  @param  b Second level
+   *  @return combined level
+   */
+  static uint16_t scale(uint16_t a, uint16_t b) {
+    return ((uint32_t)a * (b + 1UL)) >> 16;
+  }
+
+private:
+  uint16_t _master;
+  uint16_t _group[PWM_BRIGHTNESS_GROUPS];
+  uint16_t _generation;
+};
+
+#endif
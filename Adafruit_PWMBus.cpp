@@ -0,0 +1,207 @@
+/*!
+ *  @file Adafruit_PWMBus.cpp
+ *
+ *  Attached drivers hand their LED writes to queue() instead of the bus.
+ *  The bytes are copied into an application provided pool and described by
+ *  a message entry; when either fills up the queue is sent early, so a
+ *  frame larger than the pool still goes out, just in more transfers.
+ *  Register writes (MODE1, PRESCALE, ...) and reads are never queued. Not
+ *  built with PCA9685_NO_BUS.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMBus.h"
+#include "Adafruit_PWMCompletions.h"
+#include "Adafruit_PWMProfile.h"
+#include "Adafruit_PWMTiming.h"
+
+#ifndef PCA9685_NO_BUS
+
+#ifndef PCA9685_NO_TIMING
+/*!
+ *  @brief  Tells the timing models of the chips that writes go out in one
+ * transfer, which latches all of them at its single STOP
+ *  @param  msgs The writes
+ *  @param  count Number of writes
+ */
+void Adafruit_PWMBus::timingSent(const pwm_bus_msg_t *msgs, uint8_t count) {
+  uint16_t bytes = 0;
+  for (uint8_t i = 0; i < count; i++)
+    bytes += 1 + msgs[i].len; // address byte and payload
+  uint32_t started = micros();
+  for (uint8_t i = 0; i < count; i++) {
+    if (msgs[i].pwm->_timing)
+      msgs[i].pwm->_timing->sent(msgs[i].buf, msgs[i].len, started, bytes);
+  }
+}
+#endif
+
+#ifdef PCA9685_ENABLE_TRACING
+/*!
+ *  @brief  Stamps the end of a transfer and records the writes it carried
+ *  @param  msgs The writes
+ *  @param  count Number of writes
+ *  @param  started Time the transfer started
+ */
+void Adafruit_PWMBus::traceDone(pwm_bus_msg_t *msgs, uint8_t count,
+                                uint32_t started) {
+  uint32_t done = micros();
+  for (uint8_t i = 0; i < count; i++) {
+    msgs[i].trace.started = started;
+    msgs[i].trace.done = done;
+    if (msgs[i].pwm->_trace)
+      msgs[i].pwm->_trace->record(&msgs[i].trace);
+  }
+}
+#endif
+
+/*!
+ *  @brief  Instantiates a bus queue over application provided storage
+ *  @param  pool Bytes for the queued writes, 65 per full chip
+ *  @param  pool_size Size of the pool in bytes
+ *  @param  msgs One entry per queued write
+ *  @param  max_msgs Number of entries in 'msgs'
+ */
+Adafruit_PWMBus::Adafruit_PWMBus(uint8_t *pool, uint16_t pool_size,
+                                 pwm_bus_msg_t *msgs, uint8_t max_msgs)
+    : _pool(pool), _pool_size(pool_size), _used(0), _msgs(msgs),
+      _max_msgs(max_msgs), _count(0), _transfer(NULL), _context(NULL),
+      _max_per_transfer(0xFF), _failed(false), _sent(0) {}
+
+/*!
+ *  @brief  Sets how the queued writes are sent. Without a transfer function
+ * each write goes out on the I2C device of its driver
+ *  @param  transfer Function sending many writes at once, NULL for the
+ * default
+ *  @param  context Passed to 'transfer'
+ *  @param  max_per_transfer Most writes the transport takes in one call,
+ * e.g. I2C_RDWR_IOCTL_MAX_MSGS on Linux
+ */
+void Adafruit_PWMBus::setTransfer(pwm_bus_transfer_t transfer, void *context,
+                                  uint8_t max_per_transfer) {
+  _transfer = transfer;
+  _context = context;
+  _max_per_transfer = max(max_per_transfer, (uint8_t)1);
+}
+
+/*!
+ *  @brief  Queues the LED writes of a driver from now on
+ *  @param  pwm The driver, must be on this bus and begun
+ */
+void Adafruit_PWMBus::attach(Adafruit_PWMServoDriver &pwm) { pwm._bus = this; }
+
+/*!
+ *  @brief  Sends the LED writes of a driver directly again, after sending
+ * what is queued
+ *  @param  pwm The driver
+ */
+void Adafruit_PWMBus::detach(Adafruit_PWMServoDriver &pwm) {
+  if (pwm._bus != this)
+    return;
+  flush();
+  pwm._bus = NULL;
+}
+
+/*!
+ *  @brief  Sends every queued write
+ *  @return true if every write since the last flush() was sent. Frames
+ * flushed into the queue consider their channels sent, call invalidate()
+ * on them after a failure
+ */
+bool Adafruit_PWMBus::flush() {
+  bool success = send() && !_failed;
+#ifndef PCA9685_NO_COMPLETIONS
+  if (_completions)
+    _completions->post(NULL, this, PWM_DONE_FLUSH, _sent, success);
+#endif
+  _failed = false;
+  _sent = 0;
+  return success;
+}
+
+/*!
+ *  @brief  Adds a write to the queue, sending the queue first if it is full
+ *  @param  pwm Driver the write is for
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes
+ *  @return true, errors are reported by flush()
+ */
+bool Adafruit_PWMBus::queue(Adafruit_PWMServoDriver *pwm,
+                            const uint8_t *buffer, uint8_t len) {
+#ifdef PCA9685_ENABLE_TRACING
+  uint32_t encoded = micros();
+#endif
+  if (_count == _max_msgs || _used + len > _pool_size) {
+    if (!send())
+      _failed = true;
+  }
+  if (len > _pool_size || !_max_msgs) {
+    // Cannot ever be queued
+    PCA9685_PROFILE(PWM_PROFILE_BUS_WRITE);
+#ifndef PCA9685_NO_TIMING
+    if (pwm->_timing)
+      pwm->_timing->sent(buffer, len, micros(), 1 + len);
+#endif
+    if (!pwm->i2c_dev->write(buffer, len))
+      _failed = true;
+    _sent++;
+    return true;
+  }
+
+  pwm_bus_msg_t *m = &_msgs[_count++];
+  memcpy(&_pool[_used], buffer, len);
+  m->pwm = pwm;
+  m->buf = &_pool[_used];
+  m->len = len;
+  m->addr = pwm->_i2caddr;
+  _used += len;
+#ifdef PCA9685_ENABLE_TRACING
+  m->trace.entry = pwm->_trace_entry ? pwm->_trace_entry : encoded;
+  m->trace.encoded = encoded;
+  m->trace.enqueued = micros();
+#endif
+  return true;
+}
+
+/*!
+ *  @brief  Sends and empties the queue
+ *  @return success of all writes
+ */
+bool Adafruit_PWMBus::send() {
+  PCA9685_PROFILE(PWM_PROFILE_BUS_WRITE);
+  bool success = true;
+  for (uint8_t i = 0; i < _count;) {
+    uint8_t n = min((uint8_t)(_count - i), _max_per_transfer);
+#ifdef PCA9685_ENABLE_TRACING
+    uint32_t started = micros();
+#endif
+    if (_transfer) {
+#ifndef PCA9685_NO_TIMING
+      timingSent(&_msgs[i], n);
+#endif
+      success &= _transfer(_context, &_msgs[i], n);
+#ifdef PCA9685_ENABLE_TRACING
+      traceDone(&_msgs[i], n, started);
+#endif
+    } else {
+      for (uint8_t j = i; j < i + n; j++) {
+#ifndef PCA9685_NO_TIMING
+        timingSent(&_msgs[j], 1);
+#endif
+        success &= _msgs[j].pwm->i2c_dev->write(_msgs[j].buf, _msgs[j].len);
+#ifdef PCA9685_ENABLE_TRACING
+        traceDone(&_msgs[j], 1, started);
+        started = micros();
+#endif
+      }
+    }
+    i += n;
+  }
+  _sent += _count;
+  _count = 0;
+  _used = 0;
+  return success;
+}
+
+#endif
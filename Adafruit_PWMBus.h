@@ -0,0 +1,93 @@
+/*!
+ *  @file Adafruit_PWMBus.h
+ *
+ *  Queue of the LED register writes of every PCA9685 on one I2C bus, sent
+ *  together by flush() through a pluggable transfer function. On a host
+ *  where each transfer is a system call (see extras/linux_i2c) this turns
+ *  one call per chip and burst into one call per frame.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMBus_H
+#define _ADAFRUIT_PWMBus_H
+
+#include "Adafruit_PWMServoDriver.h"
+#include "Adafruit_PWMTrace.h"
+
+class Adafruit_PWMCompletions;
+
+/*!
+ *  @brief  One queued write: register address followed by the values
+ */
+typedef struct {
+  Adafruit_PWMServoDriver *pwm; ///< Chip the write is for
+  const uint8_t *buf;           ///< Register address and values
+  uint8_t len;                  ///< Bytes in 'buf'
+  uint8_t addr;                 ///< 7 bit I2C address of the chip
+#ifdef PCA9685_ENABLE_TRACING
+  pwm_trace_t trace; ///< Timestamps of the write
+#endif
+} pwm_bus_msg_t;
+
+/*!
+ *  @brief  Sends queued writes in one bus transaction
+ *  @param  context Pointer given to Adafruit_PWMBus::setTransfer()
+ *  @param  msgs Writes to send, in order
+ *  @param  count Number of writes
+ *  @return true if every write was sent
+ */
+typedef bool (*pwm_bus_transfer_t)(void *context, const pwm_bus_msg_t *msgs,
+                                   uint8_t count);
+
+/*!
+ *  @brief  Class that collects the LED writes of the chips attached to it
+ * and sends them together
+ */
+class Adafruit_PWMBus {
+public:
+  Adafruit_PWMBus(uint8_t *pool, uint16_t pool_size, pwm_bus_msg_t *msgs,
+                  uint8_t max_msgs);
+
+  void setTransfer(pwm_bus_transfer_t transfer, void *context,
+                   uint8_t max_per_transfer = 0xFF);
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void detach(Adafruit_PWMServoDriver &pwm);
+  bool flush();
+
+  /*!
+   *  @brief  Writes waiting for flush()
+   *  @return queued write count
+   */
+  uint8_t pending() const { return _count; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+  friend class Adafruit_PWMCompletions;
+
+  bool queue(Adafruit_PWMServoDriver *pwm, const uint8_t *buffer,
+             uint8_t len);
+  bool send();
+#ifndef PCA9685_NO_TIMING
+  void timingSent(const pwm_bus_msg_t *msgs, uint8_t count);
+#endif
+#ifdef PCA9685_ENABLE_TRACING
+  void traceDone(pwm_bus_msg_t *msgs, uint8_t count, uint32_t started);
+#endif
+
+  uint8_t *_pool;
+  uint16_t _pool_size;
+  uint16_t _used;
+  pwm_bus_msg_t *_msgs;
+  uint8_t _max_msgs;
+  uint8_t _count;
+  pwm_bus_transfer_t _transfer; // NULL sends each write on its own device
+  void *_context;
+  uint8_t _max_per_transfer;
+  bool _failed; // a write sent early because the queue was full failed
+  uint16_t _sent; // writes sent since the last flush()
+#ifndef PCA9685_NO_COMPLETIONS
+  Adafruit_PWMCompletions *_completions = NULL;
+#endif
+};
+
+#endif
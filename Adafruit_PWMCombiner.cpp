@@ -0,0 +1,164 @@
+/*!
+ *  @file Adafruit_PWMCombiner.cpp
+ *
+ *  The window opens with the first held write and closes when poll() or
+ *  a later write finds it older than the maximum delay, or when enough
+ *  channels are pending. Only one timestamp and a running sum are kept, so
+ *  the added delay of every write is known at flush time without storing
+ *  a time per write. Not built with PCA9685_NO_COMBINER.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMCombiner.h"
+
+#ifndef PCA9685_NO_COMBINER
+
+/*!
+ *  @brief  Instantiates a detached combiner with a 500 us window
+ */
+Adafruit_PWMCombiner::Adafruit_PWMCombiner()
+    : _pwm(NULL), _max_delay_us(PWM_COMBINE_DELAY_US),
+      _max_channels(PCA9685_NUM_CHANNELS), _count(0), _mask(0), _since(0),
+      _offsets(0) {
+  resetStats();
+}
+
+/*!
+ *  @brief  Starts holding the channel writes of a driver
+ *  @param  pwm The driver, one combiner per driver
+ */
+void Adafruit_PWMCombiner::attach(Adafruit_PWMServoDriver &pwm) {
+  detach();
+  _pwm = &pwm;
+  pwm._combiner = this;
+}
+
+/*!
+ *  @brief  Sends the held writes and lets later writes go straight to the
+ * chip
+ */
+void Adafruit_PWMCombiner::detach() {
+  if (!_pwm)
+    return;
+  flush();
+  _pwm->_combiner = NULL;
+  _pwm = NULL;
+}
+
+/*!
+ *  @brief  Sets when held writes are sent
+ *  @param  max_delay_us Longest time a write is held, 0 sends every write
+ * at once
+ *  @param  max_channels Pending channel count that sends at once, from 1
+ * to 16
+ */
+void Adafruit_PWMCombiner::setWindow(uint16_t max_delay_us,
+                                     uint8_t max_channels) {
+  _max_delay_us = max_delay_us;
+  _max_channels = constrain(max_channels, 1, PCA9685_NUM_CHANNELS);
+}
+
+/*!
+ *  @brief  Sends the held writes if the oldest one reached the maximum
+ * delay. Call often, e.g. from loop(); the delay added to a write is at
+ * most the window plus the time between two calls
+ *  @return success of the i2c writes, true if nothing was due
+ */
+bool Adafruit_PWMCombiner::poll() {
+  if (!_mask || (uint32_t)(micros() - _since) < _max_delay_us)
+    return true;
+  return flush();
+}
+
+/*!
+ *  @brief  Sends the held writes now, one burst per run of changed channels
+ *  @return success of all i2c writes, true if nothing was held
+ */
+bool Adafruit_PWMCombiner::flush() {
+  if (!_pwm || !_mask)
+    return true;
+  uint32_t open = micros() - _since;
+  _delay_sum += (uint64_t)_count * open - _offsets;
+  _held += _count;
+  if (open > _delay_max)
+    _delay_max = open;
+
+  // Same split as the driver: runs of changed channels, each in as few
+  // writes as the bus buffer allows
+  uint8_t per_write =
+      (min(_pwm->i2c_dev->maxBufferSize(),
+           (size_t)(1 + 4 * PCA9685_NUM_CHANNELS)) -
+       1) /
+      4;
+  uint16_t mask = _mask;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS;) {
+    if (!(mask & (1U << num))) {
+      num++;
+      continue;
+    }
+    uint8_t first = num;
+    while (num < PCA9685_NUM_CHANNELS && (mask & (1U << num)))
+      num++;
+    _transactions += per_write ? (num - first + per_write - 1) / per_write : 0;
+  }
+
+  _mask = 0;
+  _count = 0;
+  _offsets = 0;
+  // Detach while sending so the bursts reach the bus
+  _pwm->_combiner = NULL;
+  bool success = _pwm->writeRuns(mask, _on, _off);
+  _pwm->_combiner = this;
+  return success;
+}
+
+/*!
+ *  @brief  Clears the statistics
+ */
+void Adafruit_PWMCombiner::resetStats() {
+  _updates = 0;
+  _transactions = 0;
+  _held = 0;
+  _delay_sum = 0;
+  _delay_max = 0;
+}
+
+/*!
+ *  @brief  Holds a channel write, replacing a held one, and sends the held
+ * writes if the window is full or expired
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  on ON tick value
+ *  @param  off OFF tick value
+ */
+void Adafruit_PWMCombiner::set(uint8_t num, uint16_t on, uint16_t off) {
+  uint32_t now = micros();
+  if (_mask && (uint32_t)(now - _since) >= _max_delay_us)
+    flush();
+  if (!_mask)
+    _since = now;
+  _offsets += now - _since;
+  _count++;
+  _updates++;
+  _on[num] = on;
+  _off[num] = off;
+  _mask |= 1U << num;
+
+  uint8_t pending = 0;
+  for (uint16_t m = _mask; m; m &= m - 1)
+    pending++;
+  // The count limit also keeps '_offsets' from overflowing
+  if (pending >= _max_channels || _count == 0xFF || !_max_delay_us)
+    flush();
+}
+
+/*!
+ *  @brief  Drops the held writes, when the driver overrides every channel
+ */
+void Adafruit_PWMCombiner::discard() {
+  _mask = 0;
+  _count = 0;
+  _offsets = 0;
+}
+
+#endif
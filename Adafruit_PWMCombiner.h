@@ -0,0 +1,100 @@
+/*!
+ *  @file Adafruit_PWMCombiner.h
+ *
+ *  Write-combining window for event driven code. While attached, channel
+ *  writes of a driver are held for at most a configurable delay, or until
+ *  enough channels are pending, and then sent as one burst per run of
+ *  changed channels. Statistics show the latency added against the bus
+ *  transactions saved. Register writes (setPWMFreq(), sleep(), ...) and
+ *  getPWM() send the held writes first, so they keep their call order.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMCombiner_H
+#define _ADAFRUIT_PWMCombiner_H
+
+#include "Adafruit_PWMServoDriver.h"
+
+/** Default longest time a write is held, in microseconds */
+#define PWM_COMBINE_DELAY_US 500
+
+/*!
+ *  @brief  Class that holds the channel writes of one driver for a short
+ * window and sends them together
+ */
+class Adafruit_PWMCombiner {
+public:
+  Adafruit_PWMCombiner();
+
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void detach();
+  void setWindow(uint16_t max_delay_us,
+                 uint8_t max_channels = PCA9685_NUM_CHANNELS);
+  bool poll();
+  bool flush();
+  void resetStats();
+
+  /*!
+   *  @brief  Channels held for the next flush
+   *  @return one bit per channel, bit 0 is channel 0
+   */
+  uint16_t pendingMask() const { return _mask; }
+
+  /*!
+   *  @brief  Channel writes received while attached
+   *  @return write count
+   */
+  uint32_t updates() const { return _updates; }
+
+  /*!
+   *  @brief  I2C writes sent for them
+   *  @return transaction count
+   */
+  uint32_t transactions() const { return _transactions; }
+
+  /*!
+   *  @brief  I2C writes saved compared to sending each channel write on its
+   * own, including writes overridden before they were sent
+   *  @return saved transaction count
+   */
+  uint32_t savedTransactions() const {
+    return _updates > _transactions ? _updates - _transactions : 0;
+  }
+
+  /*!
+   *  @brief  Mean time a channel write was held before it was sent
+   *  @return delay in microseconds
+   */
+  uint32_t meanAddedDelay() const {
+    return _held ? (uint32_t)(_delay_sum / _held) : 0;
+  }
+
+  /*!
+   *  @brief  Longest time a channel write was held before it was sent
+   *  @return delay in microseconds
+   */
+  uint32_t maxAddedDelay() const { return _delay_max; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+
+  void set(uint8_t num, uint16_t on, uint16_t off);
+  void discard();
+
+  Adafruit_PWMServoDriver *_pwm;
+  uint16_t _max_delay_us;
+  uint8_t _max_channels;
+  uint8_t _count;    // writes held since the window opened
+  uint16_t _mask;    // channels held
+  uint32_t _since;   // micros() of the first held write
+  uint32_t _offsets; // sum of the held write times after '_since'
+  uint16_t _on[PCA9685_NUM_CHANNELS];
+  uint16_t _off[PCA9685_NUM_CHANNELS];
+  uint32_t _updates;
+  uint32_t _transactions;
+  uint32_t _held;
+  uint64_t _delay_sum;
+  uint32_t _delay_max;
+};
+
+#endif
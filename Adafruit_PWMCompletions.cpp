@@ -0,0 +1,114 @@
+/*!
+ *  @file Adafruit_PWMCompletions.cpp
+ *
+ *  The driver is synchronous, so an entry is posted just before the call
+ *  that completed returns. Handlers run later from processCompletions(),
+ *  in the order the operations finished, so they may start new operations
+ *  without recursing into the code that issued the first one. Posting and
+ *  processing must happen in the same thread. Not built with
+ *  PCA9685_NO_COMPLETIONS.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMCompletions.h"
+
+#ifndef PCA9685_NO_COMPLETIONS
+
+/*!
+ *  @brief  Instantiates a completion queue over application provided storage
+ *  @param  ring Array of entries, must stay valid while the queue is used
+ *  @param  size Number of entries in the ring
+ */
+Adafruit_PWMCompletions::Adafruit_PWMCompletions(pwm_completion_t *ring,
+                                                 uint8_t size)
+    : _ring(ring), _size(size), _head(0), _count(0), _overflows(0),
+      _handler(NULL), _handler_context(NULL), _notify(NULL),
+      _notify_context(NULL) {}
+
+/*!
+ *  @brief  Sets the function processCompletions() calls for each entry
+ *  @param  handler The handler, NULL to discard entries
+ *  @param  context Passed to the handler
+ */
+void Adafruit_PWMCompletions::setHandler(pwm_completion_cb_t handler,
+                                         void *context) {
+  _handler = handler;
+  _handler_context = context;
+}
+
+/*!
+ *  @brief  Sets a function called each time an entry is queued, e.g. to
+ * wake up an event loop
+ *  @param  notify The function, NULL for none
+ *  @param  context Passed to the function
+ */
+void Adafruit_PWMCompletions::setNotify(pwm_notify_t notify, void *context) {
+  _notify = notify;
+  _notify_context = context;
+}
+
+/*!
+ *  @brief  Queues the readbacks and reconfigurations of a driver
+ *  @param  pwm The driver
+ */
+void Adafruit_PWMCompletions::attach(Adafruit_PWMServoDriver &pwm) {
+  pwm._completions = this;
+}
+
+#ifndef PCA9685_NO_BUS
+/*!
+ *  @brief  Queues the flushes of a bus
+ *  @param  bus The bus
+ */
+void Adafruit_PWMCompletions::attach(Adafruit_PWMBus &bus) {
+  bus._completions = this;
+}
+#endif
+
+/*!
+ *  @brief  Runs the handler for queued completions, never blocks
+ *  @param  max Most completions to handle in this call
+ *  @return number of completions handled
+ */
+uint8_t Adafruit_PWMCompletions::processCompletions(uint8_t max) {
+  uint8_t n = 0;
+  while (_count && n < max) {
+    // Copy first, the handler may post new entries
+    pwm_completion_t c = _ring[_head];
+    _head = (_head + 1) % _size;
+    _count--;
+    if (_handler)
+      _handler(_handler_context, &c);
+    n++;
+  }
+  return n;
+}
+
+/*!
+ *  @brief  Queues a completion and notifies
+ *  @param  pwm Driver, NULL for a bus flush
+ *  @param  bus Bus of a bus flush, NULL otherwise
+ *  @param  kind One of pwm_completion_kind_t
+ *  @param  value Result of the operation
+ *  @param  success Whether all i2c transfers succeeded
+ */
+void Adafruit_PWMCompletions::post(Adafruit_PWMServoDriver *pwm,
+                                   Adafruit_PWMBus *bus, uint8_t kind,
+                                   uint16_t value, bool success) {
+  if (_count == _size) {
+    _overflows++;
+  } else {
+    pwm_completion_t *c = &_ring[(_head + _count) % _size];
+    c->pwm = pwm;
+    c->bus = bus;
+    c->kind = kind;
+    c->value = value;
+    c->success = success;
+    _count++;
+  }
+  if (_notify)
+    _notify(_notify_context);
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*!
+ *  @file Adafruit_PWMCompletions.h
+ *
+ *  Completion queue for event loops. Attached drivers and buses post an
+ *  entry when a bus flush, a readback or a reconfiguration finishes, an
+ *  optional notify hook is called for each one (on Linux it can signal an
+ *  eventfd, see extras/linux_i2c), and processCompletions() runs the
+ *  handler for the queued entries without blocking.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMCompletions_H
+#define _ADAFRUIT_PWMCompletions_H
+
+#include "Adafruit_PWMBus.h"
+
+/*!
+ *  @brief  Kinds of completed operations
+ */
+typedef enum {
+  PWM_DONE_FLUSH,  ///< Adafruit_PWMBus::flush(), value: writes sent
+  PWM_DONE_READ,   ///< getPWM(), value: register value read
+  PWM_DONE_CONFIG, ///< setPWMFreq() / setExtClk(): prescale,
+                   ///< setOutputMode(): MODE2
+} pwm_completion_kind_t;
+
+/*!
+ *  @brief  One completed operation
+ */
+typedef struct {
+  Adafruit_PWMServoDriver *pwm; ///< Driver, NULL for a bus flush
+  Adafruit_PWMBus *bus;         ///< Bus of a bus flush, NULL otherwise
+  uint16_t value;               ///< Result, see pwm_completion_kind_t
+  uint8_t kind;                 ///< One of pwm_completion_kind_t
+  bool success;                 ///< Whether all i2c transfers succeeded
+} pwm_completion_t;
+
+/*!
+ *  @brief  Handles one completion
+ *  @param  context Pointer given to Adafruit_PWMCompletions::setHandler()
+ *  @param  completion The completed operation
+ */
+typedef void (*pwm_completion_cb_t)(void *context,
+                                    const pwm_completion_t *completion);
+
+/*!
+ *  @brief  Called whenever a completion is queued
+ *  @param  context Pointer given to Adafruit_PWMCompletions::setNotify()
+ */
+typedef void (*pwm_notify_t)(void *context);
+
+/*!
+ *  @brief  Class that queues completed operations for an event loop
+ */
+class Adafruit_PWMCompletions {
+public:
+  Adafruit_PWMCompletions(pwm_completion_t *ring, uint8_t size);
+
+  void setHandler(pwm_completion_cb_t handler, void *context);
+  void setNotify(pwm_notify_t notify, void *context);
+  void attach(Adafruit_PWMServoDriver &pwm);
+#ifndef PCA9685_NO_BUS
+  void attach(Adafruit_PWMBus &bus);
+#endif
+  uint8_t processCompletions(uint8_t max = 0xFF);
+
+  /*!
+   *  @brief  Completions waiting for processCompletions()
+   *  @return queued completion count
+   */
+  uint8_t pending() const { return _count; }
+
+  /*!
+   *  @brief  Completions lost because the queue was full
+   *  @return lost completion count
+   */
+  uint16_t overflows() const { return _overflows; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+  friend class Adafruit_PWMBus;
+
+  void post(Adafruit_PWMServoDriver *pwm, Adafruit_PWMBus *bus, uint8_t kind,
+            uint16_t value, bool success);
+
+  pwm_completion_t *_ring;
+  uint8_t _size;
+  uint8_t _head; // oldest entry
+  uint8_t _count;
+  uint16_t _overflows;
+  pwm_completion_cb_t _handler;
+  void *_handler_context;
+  pwm_notify_t _notify;
+  void *_notify_context;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*!
+ *  @file Adafruit_PWMDebugLog.cpp
+ *
+ *  Single producer, single consumer ring of event records. record() only
+ *  moves the head and drain() or read() only move the tail, both as single
+ *  byte stores, so events may be recorded from an interrupt while the main
+ *  loop drains them. When the ring is full new events are counted and
+ *  reported as one PWM_LOG_DROPPED record once there is room again.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMDebugLog.h"
+
+#if (PCA9685_LOG_SIZE & (PCA9685_LOG_SIZE - 1)) || PCA9685_LOG_SIZE > 128
+#error "PCA9685_LOG_SIZE must be a power of two up to 128"
+#endif
+
+#define LOG_MASK (PCA9685_LOG_SIZE - 1)
+
+pwm_log_entry_t Adafruit_PWMDebugLog::_entries[PCA9685_LOG_SIZE];
+volatile uint8_t Adafruit_PWMDebugLog::_head = 0;
+volatile uint8_t Adafruit_PWMDebugLog::_tail = 0;
+volatile uint16_t Adafruit_PWMDebugLog::_dropped = 0;
+
+/*!
+ *  @brief  Appends an event to the log, dropping it if the log is full
+ *  @param  id One of pwm_log_event_t
+ *  @param  arg 8 bit argument
+ *  @param  a First 16 bit argument
+ *  @param  b Second 16 bit argument
+ */
+void Adafruit_PWMDebugLog::record(uint8_t id, uint8_t arg, uint16_t a,
+                                  uint16_t b) {
+  uint8_t head = _head;
+  uint8_t next = (head + 1) & LOG_MASK;
+  // Keep one slot free for the dropped record
+  if (next == _tail || (_dropped && ((next + 1) & LOG_MASK) == _tail)) {
+    if (_dropped != 0xFFFF)
+      _dropped++;
+    return;
+  }
+  if (_dropped) {
+    pwm_log_entry_t *d = &_entries[head];
+    d->time = micros();
+    d->id = PWM_LOG_DROPPED;
+    d->arg = 0;
+    d->a = _dropped;
+    d->b = 0;
+    _dropped = 0;
+    head = next;
+    next = (head + 1) & LOG_MASK;
+  }
+  pwm_log_entry_t *e = &_entries[head];
+  e->time = micros();
+  e->id = id;
+  e->arg = arg;
+  e->a = a;
+  e->b = b;
+  _head = next;
+}
+
+/*!
+ *  @brief  Takes the oldest event out of the log, for applications that
+ * forward events to their own sink
+ *  @param  entry Receives the event
+ *  @return false if the log was empty
+ */
+bool Adafruit_PWMDebugLog::read(pwm_log_entry_t *entry) {
+  uint8_t tail = _tail;
+  if (tail == _head)
+    return false;
+  *entry = _entries[tail];
+  _tail = (tail + 1) & LOG_MASK;
+  return true;
+}
+
+/*!
+ *  @brief  Writes logged events to a sink in the binary record format,
+ * call from loop() with a small 'max' to spread the output over time
+ *  @param  sink Where to write, e.g. Serial
+ *  @param  max Most records to write in this call
+ *  @return number of records written
+ */
+uint16_t Adafruit_PWMDebugLog::drain(Print &sink, uint16_t max) {
+  uint16_t n = 0;
+  pwm_log_entry_t e;
+  while (n < max && read(&e)) {
+    uint8_t buffer[PCA9685_LOG_RECORD] = {
+        PCA9685_LOG_SYNC,      e.id,
+        e.arg,                 (uint8_t)e.a,
+        (uint8_t)(e.a >> 8),   (uint8_t)e.b,
+        (uint8_t)(e.b >> 8),   (uint8_t)e.time,
+        (uint8_t)(e.time >> 8), (uint8_t)(e.time >> 16),
+        (uint8_t)(e.time >> 24)};
+    sink.write(buffer, sizeof(buffer));
+    n++;
+  }
+  return n;
+}
+
+/*!
+ *  @brief  Events lost since the last PWM_LOG_DROPPED record
+ *  @return dropped event count, saturates at 0xFFFF
+ */
+uint16_t Adafruit_PWMDebugLog::dropped() { return _dropped; }
@@ -0,0 +1,77 @@
+/*!
+ *  @file Adafruit_PWMDebugLog.h
+ *
+ *  Binary event log for the driver debug output. Events are stored as small
+ *  fixed size records in a RAM ring buffer and written out later by
+ *  drain(), so logging does not slow down the calls being traced. Decode
+ *  the drained bytes on the host with extras/debug_log/decode_log.py.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMDebugLog_H
+#define _ADAFRUIT_PWMDebugLog_H
+
+#include <Arduino.h>
+
+#include "Adafruit_PWMServoDriver_config.h"
+
+#ifndef PCA9685_LOG_SIZE
+/** Records held in RAM, a power of two up to 128 */
+#define PCA9685_LOG_SIZE 32
+#endif
+
+#define PCA9685_LOG_SYNC 0xA5   /**< First byte of every drained record */
+#define PCA9685_LOG_RECORD 11   /**< Bytes per drained record */
+
+/*!
+ *  @brief  Event IDs, shared with the host decoder
+ */
+typedef enum {
+  PWM_LOG_DROPPED = 0,  ///< a: records lost because the buffer was full
+  PWM_LOG_MODE1 = 1,    ///< arg: MODE1 value written
+  PWM_LOG_MODE2 = 2,    ///< arg: MODE2 value written
+  PWM_LOG_FREQ = 3,     ///< arg: prescale, a: requested frequency in Hz
+  PWM_LOG_PRESCALE = 4, ///< arg: prescale read, a/b: 16.16 ticks per us
+  PWM_LOG_SET_PWM = 5,  ///< arg: channel, a: ON tick, b: OFF tick
+  PWM_LOG_BURST = 6,    ///< arg: first channel, a: channel count
+  PWM_LOG_MICROS = 7,   ///< arg: channel, a: microseconds, b: OFF tick
+} pwm_log_event_t;
+
+/*!
+ *  @brief  One logged event
+ */
+typedef struct {
+  uint32_t time; ///< micros() when the event was recorded
+  uint16_t a;    ///< First 16 bit argument
+  uint16_t b;    ///< Second 16 bit argument
+  uint8_t id;    ///< One of pwm_log_event_t
+  uint8_t arg;   ///< 8 bit argument, usually the channel
+} pwm_log_entry_t;
+
+/*!
+ *  @brief  Class that holds the process wide debug event ring buffer
+ */
+class Adafruit_PWMDebugLog {
+public:
+  static void record(uint8_t id, uint8_t arg, uint16_t a = 0, uint16_t b = 0);
+  static bool read(pwm_log_entry_t *entry);
+  static uint16_t drain(Print &sink, uint16_t max = PCA9685_LOG_SIZE);
+  static uint16_t dropped();
+
+private:
+  static pwm_log_entry_t _entries[PCA9685_LOG_SIZE];
+  static volatile uint8_t _head; // next record written, producer only
+  static volatile uint8_t _tail; // next record read, consumer only
+  static volatile uint16_t _dropped;
+};
+
+#ifdef ENABLE_DEBUG_OUTPUT
+/** Records a debug event, compiled out without ENABLE_DEBUG_OUTPUT */
+#define PCA9685_LOG(id, arg, a, b) Adafruit_PWMDebugLog::record(id, arg, a, b)
+#else
+#define PCA9685_LOG(id, arg, a, b)                                             \
+  do {                                                                         \
+  } while (0) /**< Debug output disabled */
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+/*!
+ *  @file Adafruit_PWMDrift.cpp
+ *
+ *  Each interval between two fed edges is divided by the whole number of
+ *  PWM periods it spans, so missed edges do not matter, and samples more
+ *  than 1/16 away from the estimate are dropped as glitches. The rest go
+ *  through an exponential filter. At one update per second the filter
+ *  follows thermal drift while hiding edge jitter, and every correction is
+ *  a small step, so servos see no jump. When PWM_DRIFT_REACQUIRE samples
+ *  in a row are dropped but agree with each other, the estimate was wrong
+ *  from the start and their mean replaces it.
+ *
+ *  The oscillator is measured against the microcontroller clock, whose
+ *  crystal is far more accurate than the PCA9685 internal oscillator. Not
+ *  built with PCA9685_NO_DRIFT.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMDrift.h"
+
+#ifndef PCA9685_NO_DRIFT
+
+/*!
+ *  @brief  Instantiates a detached tracker
+ */
+Adafruit_PWMDrift::Adafruit_PWMDrift()
+    : _pwm(NULL), _shift(PWM_DRIFT_SHIFT), _have_edge(false), _last_edge(0),
+      _period(0), _candidate(0), _misses(0), _applied(0), _mask(0),
+      _fresh(0), _accepted(0), _rejected(0) {}
+
+/*!
+ *  @brief  Starts tracking the oscillator of a driver, from its current
+ * oscillator frequency and prescale, which may be read from the chip
+ *  @param  pwm The driver, one tracker per driver
+ */
+void Adafruit_PWMDrift::attach(Adafruit_PWMServoDriver &pwm) {
+  if (_pwm)
+    _pwm->_drift = NULL;
+  _pwm = &pwm;
+  pwm._drift = this;
+  _mask = 0;
+  restart();
+}
+
+/*!
+ *  @brief  Sets how fast the estimate follows new samples
+ *  @param  shift Each sample moves the estimate by 1 / 2^shift of its
+ * error, from 0 (no filtering) to 8
+ */
+void Adafruit_PWMDrift::setFilter(uint8_t shift) {
+  _shift = shift > 8 ? 8 : shift;
+}
+
+/*!
+ *  @brief  Feeds the time of a rising edge of a channel with ON tick 0.
+ * Edges may be skipped, but not faked; keep this cheap enough to call from
+ * the pin interrupt, or queue timestamps and feed them from loop()
+ *  @param  at_us Edge time in microseconds, micros() clock
+ */
+void Adafruit_PWMDrift::edge(uint32_t at_us) {
+  uint32_t dt = at_us - _last_edge;
+  bool first = !_have_edge;
+  _last_edge = at_us;
+  _have_edge = true;
+  if (first || !_period)
+    return;
+
+  uint32_t expected = _period >> 8;
+  uint32_t periods = (dt + expected / 2) / expected;
+  if (periods == 0 || periods > PWM_DRIFT_MAX_PERIODS) {
+    _rejected++;
+    return;
+  }
+  uint32_t sample = (dt << 8) / periods;
+  int32_t error = (int32_t)(sample - _period);
+  if ((uint32_t)(error < 0 ? -error : error) > (_period >> 4)) {
+    _rejected++;
+    reacquire(sample);
+    return;
+  }
+  _misses = 0;
+  _period += error / (1L << _shift);
+  _accepted++;
+}
+
+/*!
+ *  @brief  Applies the filtered estimate to the driver: oscillator
+ * frequency, pulse conversion factor and trims. Pulses written with
+ * writeMicroseconds() are rewritten on channels whose tick value changed,
+ * so corrections below one tick cause no I2C traffic. Call periodically
+ * from loop(), not from an interrupt
+ *  @return success of the i2c writes, true if nothing was written
+ */
+bool Adafruit_PWMDrift::update() {
+  if (!_pwm)
+    return true;
+  uint32_t old_factor = _pwm->microsecondsFactor();
+  if (old_factor != _applied) {
+    // Prescale or oscillator changed by the application, start over
+    restart();
+    return true;
+  }
+  // edge() may be running in an interrupt, do not read torn values
+  noInterrupts();
+  uint32_t period = _period;
+  uint32_t accepted = _accepted;
+  interrupts();
+  // 4096 ticks per period, 16.16 ticks per microsecond, 1/256 us period
+  uint32_t factor = (uint32_t)((1ULL << 36) / period);
+  if (!accepted || factor == old_factor)
+    return true;
+
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (_mask & (1U << num))
+      off[num] = _pwm->trimmedTicks(num, _pulse[num]);
+  }
+
+  _pwm->_oscillator_freq =
+      (uint32_t)((uint64_t)_pwm->_oscillator_freq * factor / old_factor);
+  _pwm->_us_factor = factor;
+#ifndef PCA9685_NO_TRIMS
+  _pwm->updateTrims();
+#endif
+  _applied = factor;
+
+  uint16_t changed = 0;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (!(_mask & (1U << num)))
+      continue;
+    uint16_t ticks = _pwm->trimmedTicks(num, _pulse[num]);
+    if (ticks != off[num]) {
+      on[num] = 0;
+      off[num] = ticks;
+      changed |= 1U << num;
+    }
+  }
+  _fresh = 0; // the conversions above are no channel writes
+  return changed ? _pwm->writeRuns(changed, on, off) : true;
+}
+
+/*!
+ *  @brief  Stops rewriting the pulses of some channels. Channels written
+ * with anything but the writeMicroseconds functions are released anyway
+ *  @param  mask Channels to release, one bit per channel
+ */
+void Adafruit_PWMDrift::release(uint16_t mask) { _mask &= ~mask; }
+
+/*!
+ *  @brief  Records the last pulse written to a channel
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  Microseconds Pulse length in microseconds
+ */
+void Adafruit_PWMDrift::track(uint8_t num, uint16_t Microseconds) {
+  _pulse[num] = Microseconds;
+  _mask |= 1U << num;
+  _fresh |= 1U << num;
+}
+
+/*!
+ *  @brief  Releases the channels a write overrides with something else than
+ * the pulses just given to track()
+ *  @param  mask Channels being written, one bit per channel
+ */
+void Adafruit_PWMDrift::written(uint16_t mask) {
+  _mask &= ~mask | _fresh;
+  _fresh &= ~mask;
+}
+
+/*!
+ *  @brief  Collects rejected samples, and replaces the estimate with their
+ * mean once enough of them in a row agree within 1/16
+ *  @param  sample Rejected period sample, 1/256 us
+ */
+void Adafruit_PWMDrift::reacquire(uint32_t sample) {
+  int32_t diff = (int32_t)(sample - _candidate);
+  if (!_misses ||
+      (uint32_t)(diff < 0 ? -diff : diff) > (_candidate >> 4)) {
+    _candidate = sample;
+    _misses = 1;
+    return;
+  }
+  _misses++;
+  _candidate += diff / _misses;
+  if (_misses >= PWM_DRIFT_REACQUIRE) {
+    _period = _candidate;
+    _misses = 0;
+  }
+}
+
+/*!
+ *  @brief  Restarts the estimate from the driver's conversion factor
+ */
+void Adafruit_PWMDrift::restart() {
+  uint32_t factor = _pwm->microsecondsFactor();
+  noInterrupts();
+  _applied = factor;
+  _period = factor ? (uint32_t)((1ULL << 36) / factor) : 0;
+  _have_edge = false;
+  _misses = 0;
+  _accepted = 0;
+  interrupts();
+}
+
+#endif
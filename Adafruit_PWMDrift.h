@@ -0,0 +1,89 @@
+/*!
+ *  @file Adafruit_PWMDrift.h
+ *
+ *  Online tracking of the PCA9685 oscillator, which drifts with temperature.
+ *  Feed it the times of rising edges of a channel wired back to the
+ *  microcontroller (see examples/oscillator), and it keeps the driver's
+ *  oscillator frequency and pulse conversion factor up to date, rewriting
+ *  servo pulses whose tick value changed. edge() may be called from an
+ *  interrupt, everything else from loop().
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMDrift_H
+#define _ADAFRUIT_PWMDrift_H
+
+#include "Adafruit_PWMServoDriver.h"
+
+/** Default filter weight of a new period sample, 1 / 2^shift */
+#define PWM_DRIFT_SHIFT 4
+/** Longest edge interval used, in PWM periods, so missed edges are still
+ * counted right with a few percent of drift */
+#define PWM_DRIFT_MAX_PERIODS 8
+/** Consecutive rejected samples that agree with each other and replace
+ * the estimate, so a wrong start (e.g. 27 MHz taken as 25 MHz) recovers */
+#define PWM_DRIFT_REACQUIRE 8
+
+/*!
+ *  @brief  Class that tracks the oscillator of one PCA9685 from measured
+ * PWM period edges
+ */
+class Adafruit_PWMDrift {
+public:
+  Adafruit_PWMDrift();
+
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void setFilter(uint8_t shift);
+  void edge(uint32_t at_us);
+  bool update();
+  void release(uint16_t mask);
+
+  /*!
+   *  @brief  Filtered PWM period, read it with interrupts off if edge() runs
+   * in an interrupt
+   *  @return period in 1/256 microseconds, 0 before attach()
+   */
+  uint32_t period() const { return _period; }
+
+  /*!
+   *  @brief  Channels whose pulses are rewritten on a correction
+   *  @return one bit per channel, bit 0 is channel 0
+   */
+  uint16_t trackedMask() const { return _mask; }
+
+  /*!
+   *  @brief  Edge intervals used by the filter
+   *  @return sample count
+   */
+  uint32_t accepted() const { return _accepted; }
+
+  /*!
+   *  @brief  Edge intervals dropped as glitches or gaps
+   *  @return sample count
+   */
+  uint32_t rejected() const { return _rejected; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+
+  void track(uint8_t num, uint16_t Microseconds);
+  void written(uint16_t mask);
+  void reacquire(uint32_t sample);
+  void restart();
+
+  Adafruit_PWMServoDriver *_pwm;
+  uint8_t _shift;
+  bool _have_edge;
+  uint32_t _last_edge;
+  volatile uint32_t _period; // filtered, 1/256 us
+  uint32_t _candidate;       // mean of the rejected samples in a row
+  uint8_t _misses;           // rejected samples in '_candidate'
+  uint32_t _applied;         // driver factor the period was last synced with
+  uint16_t _mask;            // channels last written with writeMicroseconds
+  uint16_t _fresh;           // channels given a pulse by the write under way
+  uint16_t _pulse[PCA9685_NUM_CHANNELS];
+  volatile uint32_t _accepted;
+  volatile uint32_t _rejected;
+};
+
+#endif
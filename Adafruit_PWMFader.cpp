@@ -0,0 +1,144 @@
+/*!
+ *  @file Adafruit_PWMFader.cpp
+ *
+ *  Per-channel fade engine for one PCA9685. Each fade keeps a 8.24 fixed
+ *  point progress accumulator that is advanced by a precomputed step per
+ *  millisecond, so update() costs one multiply-add and a table lookup per
+ *  fading channel and never touches floating point or divides. The results
+ *  are written into a frame and sent with a single flush.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMFader.h"
+
+#define CURVE_BITS 5 // curve tables have (1 << CURVE_BITS) + 1 entries
+#define CURVE_FRAC (16 - CURVE_BITS)
+
+// (2^(6x) - 1) / 63, scaled to 0..65535
+static const uint16_t fade_curve_exp[(1 << CURVE_BITS) + 1] PROGMEM = {
+    0,     144,   309,   496,   709,   952,   1229,  1543,  1902,
+    2310,  2775,  3305,  3908,  4595,  5377,  6267,  7282,  8437,
+    9752,  11250, 12955, 14898, 17110, 19629, 22498, 25764, 29485,
+    33721, 38546, 44040, 50296, 57421, 65535};
+
+// 3x^2 - 2x^3, scaled to 0..65535
+static const uint16_t fade_curve_s[(1 << CURVE_BITS) + 1] PROGMEM = {
+    0,     188,   736,   1620,  2816,  4300,  6048,  8036,  10240,
+    12636, 15200, 17908, 20736, 23660, 26656, 29700, 32768, 35835,
+    38879, 41875, 44799, 47627, 50335, 52899, 55295, 57499, 59487,
+    61235, 62719, 63915, 64799, 65347, 65535};
+
+/*!
+ *  @brief  Instantiates a fader writing into a frame
+ *  @param  frame The frame that receives the faded values
+ */
+Adafruit_PWMFader::Adafruit_PWMFader(Adafruit_PWMFrame &frame)
+    : _frame(&frame), _last(0), _active(0), _pending(0) {
+  for (uint8_t i = 0; i < PCA9685_NUM_CHANNELS; i++) {
+    _value[i] = 0;
+    _start[i] = 0;
+    _target[i] = 0;
+    _phase[i] = PWM_FADE_ONE;
+    _inc[i] = 0;
+    _curve[i] = PWM_FADE_LINEAR;
+  }
+}
+
+/*!
+ *  @brief  Starts fading a channel from its current value to a new one. The
+ * fade starts at the next call to update()
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  target The value to end at, from 0 to 4095
+ *  @param  duration Length of the fade in milliseconds, 0 jumps to the target
+ * on the next update()
+ *  @param  curve Shape of the transition
+ */
+void Adafruit_PWMFader::fadeTo(uint8_t num, uint16_t target, uint16_t duration,
+                               pwm_fade_curve_t curve) {
+  if (num >= PCA9685_NUM_CHANNELS)
+    return;
+  _start[num] = _value[num];
+  _target[num] = min(target, (uint16_t)4095);
+  _curve[num] = curve;
+  _phase[num] = 0;
+  // The only division, paid once per fade instead of once per step
+  _inc[num] = duration ? (PWM_FADE_ONE + duration / 2) / duration
+                       : PWM_FADE_ONE;
+  _active |= 1U << num;
+  _pending |= 1U << num;
+}
+
+/*!
+ *  @brief  Stops the fade of a channel, leaving it at its current value
+ *  @param  num One of the PWM output pins, from 0 to 15
+ */
+void Adafruit_PWMFader::stop(uint8_t num) {
+  if (num >= PCA9685_NUM_CHANNELS)
+    return;
+  _active &= ~(1U << num);
+  _pending &= ~(1U << num);
+}
+
+/*!
+ *  @brief  Advances every active fade to the given time and flushes the
+ * changed channels to the chip
+ *  @param  now Current time in milliseconds, typically millis()
+ *  @return success of the frame flush
+ */
+bool Adafruit_PWMFader::update(uint32_t now) {
+  uint32_t dt = now - _last;
+  _last = now;
+
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    uint16_t bit = 1U << num;
+    if (!(_active & bit))
+      continue;
+
+    if (_pending & bit) {
+      // Fade was started since the previous update, it begins now
+      _pending &= ~bit;
+      if (_inc[num] < PWM_FADE_ONE)
+        continue;
+    }
+
+    uint32_t phase = _phase[num];
+    // phase < PWM_FADE_ONE and _inc <= PWM_FADE_ONE, so 32 bits only
+    // overflow for long gaps between updates
+    if (dt < 256)
+      phase += _inc[num] * dt;
+    else
+      phase = min((uint64_t)phase + (uint64_t)_inc[num] * dt,
+                  (uint64_t)PWM_FADE_ONE);
+
+    uint16_t value;
+    if (phase >= PWM_FADE_ONE) {
+      phase = PWM_FADE_ONE;
+      value = _target[num];
+      _active &= ~bit;
+    } else {
+      uint16_t x = phase >> 8;
+      uint16_t y;
+      if (_curve[num] == PWM_FADE_LINEAR) {
+        y = x;
+      } else {
+        const uint16_t *lut = _curve[num] == PWM_FADE_EXPONENTIAL
+                                  ? fade_curve_exp
+                                  : fade_curve_s;
+        uint8_t idx = x >> CURVE_FRAC;
+        uint16_t frac = x & ((1 << CURVE_FRAC) - 1);
+        uint16_t y0 = pgm_read_word(&lut[idx]);
+        uint16_t y1 = pgm_read_word(&lut[idx + 1]);
+        y = y0 + (((uint32_t)(y1 - y0) * frac) >> CURVE_FRAC);
+      }
+      int32_t delta = (int32_t)_target[num] - _start[num];
+      value = _start[num] + ((delta * y) >> 16);
+    }
+    _phase[num] = phase;
+
+    _value[num] = value;
+    _frame->setPin(num, value);
+  }
+
+  return _frame->flush();
+}
@@ -0,0 +1,64 @@
+/*!
+ *  @file Adafruit_PWMFader.h
+ *
+ *  Per-channel fade engine for one PCA9685, using integer math only.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMFader_H
+#define _ADAFRUIT_PWMFader_H
+
+#include "Adafruit_PWMFrame.h"
+
+#define PWM_FADE_ONE (1UL << 24) /**< Fade progress of a finished fade */
+
+/*!
+ *  @brief  Shape of the transition between the start and target value
+ */
+typedef enum {
+  PWM_FADE_LINEAR,      ///< Constant rate of change
+  PWM_FADE_EXPONENTIAL, ///< Slow start, perceptually even for LEDs
+  PWM_FADE_SCURVE,      ///< Eased in and out (smoothstep)
+} pwm_fade_curve_t;
+
+/*!
+ *  @brief  Class that advances up to 16 concurrent fades and writes the
+ * results into a frame
+ */
+class Adafruit_PWMFader {
+public:
+  Adafruit_PWMFader(Adafruit_PWMFrame &frame);
+
+  void fadeTo(uint8_t num, uint16_t target, uint16_t duration,
+              pwm_fade_curve_t curve = PWM_FADE_LINEAR);
+  void stop(uint8_t num);
+  bool update(uint32_t now);
+
+  /*!
+   *  @brief  Checks if a channel is still fading
+   *  @param  num One of the PWM output pins, from 0 to 15
+   *  @return true while the fade is in progress
+   */
+  bool isFading(uint8_t num) const { return (_active >> num) & 1; }
+  /*!
+   *  @brief  The value last written to a channel by the fader
+   *  @param  num One of the PWM output pins, from 0 to 15
+   *  @return value from 0 to 4095
+   */
+  uint16_t getValue(uint8_t num) const { return _value[num]; }
+
+private:
+  Adafruit_PWMFrame *_frame;
+  uint32_t _last;
+  uint16_t _active;
+  uint16_t _pending;
+
+  uint16_t _value[PCA9685_NUM_CHANNELS];
+  uint16_t _start[PCA9685_NUM_CHANNELS];
+  uint16_t _target[PCA9685_NUM_CHANNELS];
+  uint32_t _phase[PCA9685_NUM_CHANNELS]; // progress, PWM_FADE_ONE when done
+  uint32_t _inc[PCA9685_NUM_CHANNELS];   // progress per millisecond
+  uint8_t _curve[PCA9685_NUM_CHANNELS];
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*!
+ *  @file Adafruit_PWMFixture.cpp
+ *
+ *  RGB and RGBW fixtures. Colors are converted with integer math only: HSV
+ *  uses the same 1530 step hue wheel as Adafruit_NeoPixel::ColorHSV(), each
+ *  fixture applies its own 3x3 calibration matrix in 8.8 fixed point for
+ *  white balance and LED mismatch, and the 16-bit linear result goes through
+ *  an interpolated gamma table to 12-bit PWM values. All fixtures on a chip
+ *  share one frame, so they are sent together by a single flush.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMFixture.h"
+
+// Gamma 2.2, 8-bit input to 12-bit output, one extra entry for interpolation
+static const uint16_t fixture_gamma[257] PROGMEM = {
+    0,    0,    0,    0,    0,    1,    1,    2,    2,    3,    3,    4,
+    5,    6,    7,    8,    9,    11,   12,   14,   15,   17,   19,   21,
+    23,   25,   27,   29,   32,   34,   37,   40,   43,   46,   49,   52,
+    55,   59,   62,   66,   70,   73,   77,   82,   86,   90,   95,   99,
+    104,  109,  114,  119,  124,  129,  135,  140,  146,  152,  158,  164,
+    170,  176,  182,  189,  196,  202,  209,  216,  224,  231,  238,  246,
+    254,  261,  269,  277,  286,  294,  302,  311,  320,  328,  337,  347,
+    356,  365,  375,  384,  394,  404,  414,  424,  435,  445,  456,  467,
+    477,  488,  500,  511,  522,  534,  545,  557,  569,  581,  594,  606,
+    619,  631,  644,  657,  670,  683,  697,  710,  724,  738,  752,  766,
+    780,  794,  809,  823,  838,  853,  868,  884,  899,  914,  930,  946,
+    962,  978,  994,  1011, 1027, 1044, 1061, 1078, 1095, 1112, 1130, 1147,
+    1165, 1183, 1201, 1219, 1237, 1256, 1274, 1293, 1312, 1331, 1350, 1370,
+    1389, 1409, 1429, 1449, 1469, 1489, 1509, 1530, 1551, 1572, 1593, 1614,
+    1635, 1657, 1678, 1700, 1722, 1744, 1766, 1789, 1811, 1834, 1857, 1880,
+    1903, 1926, 1950, 1974, 1997, 2021, 2045, 2070, 2094, 2119, 2143, 2168,
+    2193, 2219, 2244, 2270, 2295, 2321, 2347, 2373, 2400, 2426, 2453, 2479,
+    2506, 2534, 2561, 2588, 2616, 2644, 2671, 2700, 2728, 2756, 2785, 2813,
+    2842, 2871, 2900, 2930, 2959, 2989, 3019, 3049, 3079, 3109, 3140, 3170,
+    3201, 3232, 3263, 3295, 3326, 3358, 3390, 3421, 3454, 3486, 3518, 3551,
+    3584, 3617, 3650, 3683, 3716, 3750, 3784, 3818, 3852, 3886, 3920, 3955,
+    3990, 4025, 4060, 4095, 4095};
+
+// Black body color from 1000K to 12000K in 500K steps
+#define CT_MIN 1000
+#define CT_STEP 500
+#define CT_COUNT 23
+static const uint8_t fixture_ct[CT_COUNT][3] PROGMEM = {
+    {255, 68, 0},    // 1000K
+    {255, 108, 0},   // 1500K
+    {255, 137, 14},  // 2000K
+    {255, 159, 70},  // 2500K
+    {255, 177, 110}, // 3000K
+    {255, 193, 141}, // 3500K
+    {255, 206, 166}, // 4000K
+    {255, 218, 187}, // 4500K
+    {255, 228, 206}, // 5000K
+    {255, 237, 222}, // 5500K
+    {255, 246, 237}, // 6000K
+    {255, 254, 250}, // 6500K
+    {243, 242, 255}, // 7000K
+    {230, 235, 255}, // 7500K
+    {221, 230, 255}, // 8000K
+    {215, 226, 255}, // 8500K
+    {210, 223, 255}, // 9000K
+    {205, 220, 255}, // 9500K
+    {202, 218, 255}, // 10000K
+    {199, 216, 255}, // 10500K
+    {196, 214, 255}, // 11000K
+    {193, 213, 255}, // 11500K
+    {191, 211, 255}, // 12000K
+};
+
+/*!
+ *  @brief  Instantiates a fixture on consecutive channels of a frame, in red,
+ * green, blue (, white) order
+ *  @param  frame The frame of the chip the fixture is on
+ *  @param  first Channel of the red LED, from 0 to 13 (0 to 12 for RGBW)
+ *  @param  rgbw If true, the fixture has a white LED on channel first + 3
+ */
+Adafruit_PWMFixture::Adafruit_PWMFixture(Adafruit_PWMFrame &frame,
+                                         uint8_t first, bool rgbw)
+    : _frame(&frame), _first(first), _rgbw(rgbw) {
+  setWhiteBalance(PWM_FIXTURE_UNITY, PWM_FIXTURE_UNITY, PWM_FIXTURE_UNITY);
+}
+
+/*!
+ *  @brief  Sets the color calibration matrix of the fixture, applied to
+ * every color before gamma correction
+ *  @param  matrix 9 factors in row major order, 8.8 fixed point
+ * (PWM_FIXTURE_UNITY is 1.0). Row 0 gives the red output from the r, g and b
+ * inputs, and so on
+ */
+void Adafruit_PWMFixture::setCalibration(const int16_t *matrix) {
+  memcpy(_matrix, matrix, sizeof(_matrix));
+}
+
+/*!
+ *  @brief  Sets a diagonal calibration matrix, i.e. a gain per color
+ *  @param  r Red gain, 8.8 fixed point
+ *  @param  g Green gain, 8.8 fixed point
+ *  @param  b Blue gain, 8.8 fixed point
+ */
+void Adafruit_PWMFixture::setWhiteBalance(int16_t r, int16_t g, int16_t b) {
+  memset(_matrix, 0, sizeof(_matrix));
+  _matrix[0] = r;
+  _matrix[4] = g;
+  _matrix[8] = b;
+}
+
+/*!
+ *  @brief  Sets the fixture color. For RGBW fixtures the common part of the
+ * three colors is moved to the white LED
+ *  @param  r Red, 0 to 255
+ *  @param  g Green, 0 to 255
+ *  @param  b Blue, 0 to 255
+ */
+void Adafruit_PWMFixture::setRGB(uint8_t r, uint8_t g, uint8_t b) {
+  uint16_t out[3];
+  for (uint8_t row = 0; row < 3; row++) {
+    const int16_t *m = &_matrix[row * 3];
+    int32_t sum = (int32_t)m[0] * r + (int32_t)m[1] * g + (int32_t)m[2] * b;
+    out[row] = constrain(sum, (int32_t)0, (int32_t)0xFFFF);
+  }
+
+  if (_rgbw) {
+    uint16_t w = min(out[0], min(out[1], out[2]));
+    for (uint8_t i = 0; i < 3; i++)
+      out[i] -= w;
+    _frame->setPin(_first + 3, gamma(w));
+  }
+  for (uint8_t i = 0; i < 3; i++)
+    _frame->setPin(_first + i, gamma(out[i]));
+}
+
+/*!
+ *  @brief  Sets the fixture color from hue, saturation and value
+ *  @param  hue Hue, 0 to 65535 for a full turn starting at red
+ *  @param  sat Saturation, 0 to 255
+ *  @param  val Value (brightness), 0 to 255
+ */
+void Adafruit_PWMFixture::setHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+  uint8_t r, g, b;
+  HSVtoRGB(hue, sat, val, &r, &g, &b);
+  setRGB(r, g, b);
+}
+
+/*!
+ *  @brief  Sets the fixture to the color of a black body
+ *  @param  kelvin Color temperature, 1000 to 12000
+ *  @param  val Brightness, 0 to 255
+ */
+void Adafruit_PWMFixture::setColorTemperature(uint16_t kelvin, uint8_t val) {
+  kelvin = constrain(kelvin, CT_MIN, CT_MIN + CT_STEP * (CT_COUNT - 1));
+  uint8_t idx = (kelvin - CT_MIN) / CT_STEP;
+  uint16_t frac = (kelvin - CT_MIN) - idx * CT_STEP;
+  uint8_t next = min(idx + 1, CT_COUNT - 1);
+
+  uint8_t rgb[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    int16_t c0 = pgm_read_byte(&fixture_ct[idx][i]);
+    int16_t c1 = pgm_read_byte(&fixture_ct[next][i]);
+    uint16_t c = c0 + (int32_t)(c1 - c0) * frac / CT_STEP;
+    rgb[i] = (c * (val + 1)) >> 8;
+  }
+  setRGB(rgb[0], rgb[1], rgb[2]);
+}
+
+/*!
+ *  @brief  Converts hue, saturation and value to 8-bit RGB, using the same
+ * integer hue wheel as Adafruit_NeoPixel::ColorHSV()
+ *  @param  hue Hue, 0 to 65535 for a full turn starting at red
+ *  @param  sat Saturation, 0 to 255
+ *  @param  val Value (brightness), 0 to 255
+ *  @param  r Receives red, 0 to 255
+ *  @param  g Receives green, 0 to 255
+ *  @param  b Receives blue, 0 to 255
+ */
+void Adafruit_PWMFixture::HSVtoRGB(uint16_t hue, uint8_t sat, uint8_t val,
+                                   uint8_t *r, uint8_t *g, uint8_t *b) {
+  uint8_t rr, gg, bb;
+
+  // Remap 0-65535 to 0-1529, each sixth of the wheel is 255 steps
+  hue = (hue * 1530L + 32768) / 65536;
+  if (hue < 510) { // Red to Green-1
+    bb = 0;
+    if (hue < 255) { //   Red to Yellow-1
+      rr = 255;
+      gg = hue;
+    } else { //           Yellow to Green-1
+      rr = 510 - hue;
+      gg = 255;
+    }
+  } else if (hue < 1020) { // Green to Blue-1
+    rr = 0;
+    if (hue < 765) { //   Green to Cyan-1
+      gg = 255;
+      bb = hue - 510;
+    } else { //           Cyan to Blue-1
+      gg = 1020 - hue;
+      bb = 255;
+    }
+  } else if (hue < 1530) { // Blue to Red-1
+    gg = 0;
+    if (hue < 1275) { //  Blue to Magenta-1
+      rr = hue - 1020;
+      bb = 255;
+    } else { //           Magenta to Red-1
+      rr = 255;
+      bb = 1530 - hue;
+    }
+  } else { // Last 0.5 Red (quicker than % operator)
+    rr = 255;
+    gg = bb = 0;
+  }
+
+  // Apply saturation and value to R,G,B
+  uint16_t v1 = 1 + val;
+  uint16_t s1 = 1 + sat;
+  uint8_t s2 = 255 - sat;
+  *r = ((((rr * s1) >> 8) + s2) * v1) >> 8;
+  *g = ((((gg * s1) >> 8) + s2) * v1) >> 8;
+  *b = ((((bb * s1) >> 8) + s2) * v1) >> 8;
+}
+
+/*!
+ *  @brief  Gamma corrects a linear intensity
+ *  @param  x Linear intensity, 255 * 256 is full scale
+ *  @return PWM value from 0 to 4095
+ */
+uint16_t Adafruit_PWMFixture::gamma(uint16_t x) {
+  uint8_t idx = x >> 8;
+  uint8_t frac = x;
+  uint16_t y0 = pgm_read_word(&fixture_gamma[idx]);
+  uint16_t y1 = pgm_read_word(&fixture_gamma[idx + 1]);
+  return y0 + (((uint32_t)(y1 - y0) * frac) >> 8);
+}
@@ -0,0 +1,42 @@
+/*!
+ *  @file Adafruit_PWMFixture.h
+ *
+ *  RGB and RGBW light fixtures built from 3 or 4 channels of a PCA9685.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMFixture_H
+#define _ADAFRUIT_PWMFixture_H
+
+#include "Adafruit_PWMFrame.h"
+
+#define PWM_FIXTURE_UNITY 256 /**< Calibration factor of 1.0 (8.8 format) */
+
+/*!
+ *  @brief  Class that converts colors for one fixture into gamma corrected
+ * channel values in a frame
+ */
+class Adafruit_PWMFixture {
+public:
+  Adafruit_PWMFixture(Adafruit_PWMFrame &frame, uint8_t first,
+                      bool rgbw = false);
+
+  void setCalibration(const int16_t *matrix);
+  void setWhiteBalance(int16_t r, int16_t g, int16_t b);
+
+  void setRGB(uint8_t r, uint8_t g, uint8_t b);
+  void setHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+  void setColorTemperature(uint16_t kelvin, uint8_t val = 255);
+
+  static void HSVtoRGB(uint16_t hue, uint8_t sat, uint8_t val, uint8_t *r,
+                       uint8_t *g, uint8_t *b);
+  static uint16_t gamma(uint16_t x);
+
+private:
+  Adafruit_PWMFrame *_frame;
+  uint8_t _first;
+  bool _rgbw;
+  int16_t _matrix[9]; // row major, 8.8 fixed point
+};
+
+#endif
@@ -0,0 +1,219 @@
+/*!
+ *  @file Adafruit_PWMFrame.cpp
+ *
+ *  Shadow image of the 16 PWM outputs of one PCA9685. Channel updates only
+ *  touch RAM, flush() then sends every changed channel using auto-increment
+ *  bursts, joining nearby runs so a frame costs a handful of I2C writes
+ *  instead of one per channel.
+ *
+ *  Brightness levels are applied during flush(): the frame keeps both the
+ *  values set by the application and the outputs last sent, so a level
+ *  change recomputes every output with one multiply per channel and only
+ *  the channels whose output really changed go on the bus.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMFrame.h"
+
+/*!
+ *  @brief  Instantiates a frame for a PCA9685 driver. The image starts as
+ * every channel fully off, which is the state of the chip after reset
+ *  @param  pwm The driver the frame is flushed to
+ */
+Adafruit_PWMFrame::Adafruit_PWMFrame(Adafruit_PWMServoDriver &pwm)
+    : _pwm(&pwm), _levels(NULL), _dirty(0), _stale(0),
+      _chip_level(PWM_BRIGHTNESS_FULL), _generation(0), _rescale(false) {
+  for (uint8_t i = 0; i < PCA9685_NUM_CHANNELS; i++) {
+    _on[i] = _out_on[i] = 0;
+    _off[i] = _out_off[i] = 4096;
+    _group[i] = 0;
+  }
+}
+
+/*!
+ *  @brief  Sets the pending PWM output of one channel, see
+ * Adafruit_PWMServoDriver::setPWM()
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  on At what point in the 4096-part cycle to turn the PWM output ON
+ *  @param  off At what point in the 4096-part cycle to turn the PWM output OFF
+ */
+void Adafruit_PWMFrame::setPWM(uint8_t num, uint16_t on, uint16_t off) {
+  if (num >= PCA9685_NUM_CHANNELS)
+    return;
+  if (_on[num] == on && _off[num] == off)
+    return;
+  _on[num] = on;
+  _off[num] = off;
+  _dirty |= 1U << num;
+}
+
+/*!
+ *  @brief  Sets the pending output of one channel, see
+ * Adafruit_PWMServoDriver::setPin()
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  val The number of ticks out of 4096 to be active
+ *  @param  invert If true, inverts the output, defaults to 'false'
+ */
+void Adafruit_PWMFrame::setPin(uint8_t num, uint16_t val, bool invert) {
+  uint16_t on, off;
+  Adafruit_PWMServoDriver::pinToPWM(val, invert, &on, &off);
+  setPWM(num, on, off);
+}
+
+/*!
+ *  @brief  Gets the pending ON tick of one channel
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @return ON tick value
+ */
+uint16_t Adafruit_PWMFrame::getOn(uint8_t num) const {
+  return num < PCA9685_NUM_CHANNELS ? _on[num] : 0;
+}
+
+/*!
+ *  @brief  Gets the pending OFF tick of one channel
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @return OFF tick value
+ */
+uint16_t Adafruit_PWMFrame::getOff(uint8_t num) const {
+  return num < PCA9685_NUM_CHANNELS ? _off[num] : 0;
+}
+
+/*!
+ *  @brief  Marks every channel as changed, so the next flush() rewrites the
+ * whole chip, e.g. after a reset or when the chip state is unknown
+ */
+void Adafruit_PWMFrame::invalidate() { _stale = 0xFFFF; }
+
+/*!
+ *  @brief  Attaches master and group brightness levels, which may be shared
+ * by many frames
+ *  @param  levels The levels to apply, NULL for none
+ */
+void Adafruit_PWMFrame::setBrightness(Adafruit_PWMBrightness *levels) {
+  _levels = levels;
+  _rescale = true;
+}
+
+/*!
+ *  @brief  Sets the brightness of this chip, applied on top of the master
+ * and group levels
+ *  @param  level Level, from 0 (off) to PWM_BRIGHTNESS_FULL
+ */
+void Adafruit_PWMFrame::setChipBrightness(uint16_t level) {
+  if (_chip_level == level)
+    return;
+  _chip_level = level;
+  _rescale = true;
+}
+
+/*!
+ *  @brief  Assigns a channel to a brightness group
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  group Group number, PWM_GROUP_NONE for channels that must never
+ * dim such as servos. Channels start in group 0
+ */
+void Adafruit_PWMFrame::setChannelGroup(uint8_t num, uint8_t group) {
+  if (num >= PCA9685_NUM_CHANNELS || _group[num] == group)
+    return;
+  _group[num] = group;
+  _dirty |= 1U << num;
+}
+
+/*!
+ *  @brief  Sends every channel whose output changed to the chip. Runs of
+ * changed channels separated by at most PCA9685_FRAME_MERGE_GAP unchanged
+ * channels are sent as a single burst
+ *  @return success of all i2c writes, on failure the channels are retried on
+ * the next flush
+ */
+bool Adafruit_PWMFrame::flush() {
+  if (_levels && _levels->generation() != _generation) {
+    _generation = _levels->generation();
+    _rescale = true;
+  }
+  uint16_t recompute = _rescale ? 0xFFFF : _dirty;
+  _rescale = false;
+  _dirty = 0;
+
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  memcpy(on, _out_on, sizeof(on));
+  memcpy(off, _out_off, sizeof(off));
+
+  uint16_t send = _stale;
+  _stale = 0;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    uint16_t bit = 1U << num;
+    if (!(recompute & bit))
+      continue;
+    uint16_t level = PWM_BRIGHTNESS_FULL;
+    if (_group[num] != PWM_GROUP_NONE) {
+      level = _chip_level;
+      if (_levels)
+        level = Adafruit_PWMBrightness::scale(_levels->level(_group[num]),
+                                              level);
+    }
+    scaleOutput(num, level, &on[num], &off[num]);
+    if (on[num] != _out_on[num] || off[num] != _out_off[num])
+      send |= bit;
+  }
+
+  bool success = true;
+  uint8_t num = 0;
+  while (send >> num) {
+    if (!(send & (1U << num))) {
+      num++;
+      continue;
+    }
+    uint8_t first = num;
+    uint8_t last = num;
+    for (num++; num < PCA9685_NUM_CHANNELS; num++) {
+      if (send & (1U << num))
+        last = num;
+      else if (num - last > PCA9685_FRAME_MERGE_GAP)
+        break;
+    }
+    uint8_t count = last - first + 1;
+    if (_pwm->setPWMBurst(first, count, &on[first], &off[first])) {
+      memcpy(&_out_on[first], &on[first], count * sizeof(uint16_t));
+      memcpy(&_out_off[first], &off[first], count * sizeof(uint16_t));
+    } else {
+      uint16_t run = ((1UL << count) - 1) << first;
+      _stale |= run;
+      _dirty |= run;
+      success = false;
+    }
+    num = last + 1;
+  }
+  return success;
+}
+
+/*!
+ *  @brief  Computes the output of a channel at a brightness level, keeping
+ * its ON tick (phase) and scaling its duty cycle
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  level Brightness level, PWM_BRIGHTNESS_FULL leaves it unchanged
+ *  @param  on Receives the ON tick value
+ *  @param  off Receives the OFF tick value
+ */
+void Adafruit_PWMFrame::scaleOutput(uint8_t num, uint16_t level, uint16_t *on,
+                                    uint16_t *off) const {
+  *on = _on[num];
+  *off = _off[num];
+  if (level == PWM_BRIGHTNESS_FULL || (*off & 4096))
+    return;
+
+  uint16_t duty = (*on & 4096) ? 4096 : (*off - *on) & 0xFFF;
+  duty = ((uint32_t)duty * (level + 1UL)) >> 16;
+  if (duty == 0) {
+    // Special value for signal fully off.
+    *on = 0;
+    *off = 4096;
+  } else if (!(*on & 4096)) {
+    *off = (*on + duty) & 0xFFF;
+  } else if (duty < 4096) {
+    *on = 0;
+    *off = duty;
+  }
+}
@@ -0,0 +1,69 @@
+/*!
+ *  @file Adafruit_PWMFrame.h
+ *
+ *  Shadow image of the 16 PWM outputs of one PCA9685, so that many channel
+ *  updates can be collected and sent to the chip in as few I2C writes as
+ *  possible, with optional brightness scaling applied on the way out.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMFrame_H
+#define _ADAFRUIT_PWMFrame_H
+
+#include "Adafruit_PWMBrightness.h"
+#include "Adafruit_PWMServoDriver.h"
+
+/** Clean channels between two dirty runs that are cheaper to resend than to
+ * start a new I2C write for */
+#define PCA9685_FRAME_MERGE_GAP 1
+
+/*!
+ *  @brief  Class that stores the pending output state of one PCA9685 and
+ * flushes the changed channels in batched writes
+ */
+class Adafruit_PWMFrame {
+public:
+  Adafruit_PWMFrame(Adafruit_PWMServoDriver &pwm);
+
+  void setPWM(uint8_t num, uint16_t on, uint16_t off);
+  void setPin(uint8_t num, uint16_t val, bool invert = false);
+  uint16_t getOn(uint8_t num) const;
+  uint16_t getOff(uint8_t num) const;
+
+  /*!
+   *  @brief  Bitmask of the channels changed since the last flush()
+   *  @return one bit per channel, bit 0 is channel 0
+   */
+  uint16_t dirtyMask() const { return _dirty | _stale; }
+  void invalidate();
+  bool flush();
+
+  void setBrightness(Adafruit_PWMBrightness *levels);
+  void setChipBrightness(uint16_t level);
+  void setChannelGroup(uint8_t num, uint8_t group);
+
+  /*!
+   *  @brief  The driver this frame flushes to
+   *  @return reference to the driver
+   */
+  Adafruit_PWMServoDriver &driver() { return *_pwm; }
+
+private:
+  void scaleOutput(uint8_t num, uint16_t level, uint16_t *on,
+                   uint16_t *off) const;
+
+  Adafruit_PWMServoDriver *_pwm;
+  Adafruit_PWMBrightness *_levels;
+  uint16_t _on[PCA9685_NUM_CHANNELS]; // as set by the application
+  uint16_t _off[PCA9685_NUM_CHANNELS];
+  uint16_t _out_on[PCA9685_NUM_CHANNELS]; // as last sent to the chip
+  uint16_t _out_off[PCA9685_NUM_CHANNELS];
+  uint8_t _group[PCA9685_NUM_CHANNELS];
+  uint16_t _dirty; // set since the last flush, output must be recomputed
+  uint16_t _stale; // chip content unknown, must be sent
+  uint16_t _chip_level;
+  uint16_t _generation; // brightness generation of the sent outputs
+  bool _rescale;        // brightness changed, recompute every channel
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*!
+ *  @file Adafruit_PWMGroupMove.cpp
+ *
+ *  Coordinated group moves. All channels of a group share one fixed point
+ *  progress accumulator, so each channel's velocity is its own travel
+ *  divided by the common duration and every channel starts and arrives on
+ *  the same update. After each step every chip involved is flushed once.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMGroupMove.h"
+
+#define PWM_GROUP_ONE (1UL << 24) // progress of a finished move
+
+/*!
+ *  @brief  Instantiates a group move over a set of channels
+ *  @param  members Array of channels, fill in frame and num for each. Must
+ * stay valid while the group is used
+ *  @param  count Number of channels in the group
+ */
+Adafruit_PWMGroupMove::Adafruit_PWMGroupMove(pwm_group_member_t *members,
+                                             uint8_t count)
+    : _members(members), _count(count), _moving(false), _pending(false),
+      _last(0), _phase(PWM_GROUP_ONE), _inc(0) {}
+
+/*!
+ *  @brief  Starts moving every channel from its current frame value to a new
+ * target, with the channel that travels the furthest going at 'speed'. The
+ * move starts at the next call to update()
+ *  @param  targets Array of OFF tick targets, one per group member
+ *  @param  speed Maximum speed in ticks per second
+ *  @return duration of the move in milliseconds
+ */
+uint16_t Adafruit_PWMGroupMove::moveTo(const uint16_t *targets,
+                                       uint16_t speed) {
+  uint16_t longest = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    uint16_t current = _members[i].frame->getOff(_members[i].num);
+    uint16_t travel =
+        targets[i] > current ? targets[i] - current : current - targets[i];
+    longest = max(longest, travel);
+  }
+  uint16_t duration =
+      speed ? min((uint32_t)longest * 1000 / speed, (uint32_t)0xFFFF) : 0;
+  moveToIn(targets, duration);
+  return duration;
+}
+
+/*!
+ *  @brief  Starts moving every channel from its current frame value to a new
+ * target, arriving together after 'duration'. The move starts at the next
+ * call to update()
+ *  @param  targets Array of OFF tick targets, one per group member
+ *  @param  duration Length of the move in milliseconds
+ */
+void Adafruit_PWMGroupMove::moveToIn(const uint16_t *targets,
+                                     uint16_t duration) {
+  for (uint8_t i = 0; i < _count; i++) {
+    _members[i].start = _members[i].frame->getOff(_members[i].num);
+    _members[i].target = min(targets[i], (uint16_t)4095);
+  }
+  _phase = 0;
+  _inc = duration ? (PWM_GROUP_ONE + duration / 2) / duration : PWM_GROUP_ONE;
+  _moving = true;
+  _pending = true;
+}
+
+/*!
+ *  @brief  Advances the move to the given time, writes every channel into
+ * its frame and flushes each chip once
+ *  @param  now Current time in milliseconds, typically millis()
+ *  @return success of all frame flushes
+ */
+bool Adafruit_PWMGroupMove::update(uint32_t now) {
+  uint32_t dt = now - _last;
+  _last = now;
+  if (!_moving)
+    return true;
+
+  if (_pending) {
+    // Move was started since the previous update, it begins now
+    _pending = false;
+    dt = _inc < PWM_GROUP_ONE ? 0 : 1;
+  }
+
+  if (dt >= (PWM_GROUP_ONE - _phase + _inc - 1) / _inc) {
+    _phase = PWM_GROUP_ONE;
+    _moving = false;
+  } else {
+    _phase += _inc * dt;
+  }
+
+  uint16_t x = _phase >> 8;
+  for (uint8_t i = 0; i < _count; i++) {
+    pwm_group_member_t *m = &_members[i];
+    uint16_t value;
+    if (!_moving) {
+      value = m->target;
+    } else {
+      int32_t delta = (int32_t)m->target - m->start;
+      value = m->start + ((delta * x) >> 16);
+    }
+    m->frame->setPWM(m->num, 0, value);
+  }
+
+  // Frames are clean after their first flush, so each chip commits once
+  bool success = true;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_members[i].frame->dirtyMask())
+      success &= _members[i].frame->flush();
+  }
+  return success;
+}
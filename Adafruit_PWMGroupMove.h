@@ -0,0 +1,52 @@
+/*!
+ *  @file Adafruit_PWMGroupMove.h
+ *
+ *  Coordinated moves of several servo channels, possibly on several
+ *  PCA9685 chips, that start and arrive together.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMGroupMove_H
+#define _ADAFRUIT_PWMGroupMove_H
+
+#include "Adafruit_PWMFrame.h"
+
+/*!
+ *  @brief  One channel taking part in a group move
+ */
+typedef struct {
+  Adafruit_PWMFrame *frame; ///< Frame of the chip the channel is on
+  uint8_t num;              ///< Channel on that chip, from 0 to 15
+  uint16_t start;           ///< Used internally, OFF tick at move start
+  uint16_t target;          ///< Used internally, OFF tick at move end
+} pwm_group_member_t;
+
+/*!
+ *  @brief  Class that moves a set of channels so they all finish at the
+ * same time, committing each chip once per update
+ */
+class Adafruit_PWMGroupMove {
+public:
+  Adafruit_PWMGroupMove(pwm_group_member_t *members, uint8_t count);
+
+  uint16_t moveTo(const uint16_t *targets, uint16_t speed);
+  void moveToIn(const uint16_t *targets, uint16_t duration);
+  bool update(uint32_t now);
+
+  /*!
+   *  @brief  Checks if the group is still moving
+   *  @return true until every channel has reached its target
+   */
+  bool isMoving() const { return _moving; }
+
+private:
+  pwm_group_member_t *_members;
+  uint8_t _count;
+  bool _moving;
+  bool _pending;
+  uint32_t _last;
+  uint32_t _phase; // shared progress, PWM_GROUP_ONE when done
+  uint32_t _inc;   // progress per millisecond
+};
+
+#endif
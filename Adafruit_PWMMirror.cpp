@@ -0,0 +1,289 @@
+/*!
+ *  @file Adafruit_PWMMirror.cpp
+ *
+ *  Every register write is streamed as one record: the sync byte, the chip
+ *  address, the first register, the data length, the register values and
+ *  an 8 bit sum of the bytes after the sync byte. The standby drops records
+ *  with a bad sum and waits for the next sync byte, so it recovers from
+ *  lost bytes. A lost LED record is repaired by takeover(), which reads the
+ *  chip.
+ *
+ *  A takeover costs 2 register reads, one burst read of the LED registers
+ *  and a write per run of diverged channels: about 2 ms at 400 kHz,
+ *  well inside one 50 Hz PWM period. Outputs keep running meanwhile. Not
+ *  built with PCA9685_NO_MIRROR.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMMirror.h"
+
+#ifndef PCA9685_NO_MIRROR
+
+/*!
+ *  @brief  Instantiates a mirror
+ *  @param  states Shadow storage for the standby, one per chip, NULL on the
+ * active controller
+ *  @param  count Number of states
+ */
+Adafruit_PWMMirror::Adafruit_PWMMirror(pwm_mirror_state_t *states,
+                                       uint8_t count)
+    : _out(NULL), _in(NULL), _states(states), _count(count), _rx_len(0),
+      _rx_sync(false), _errors(0) {
+  for (uint8_t i = 0; i < _count; i++)
+    _states[i].addr = 0;
+}
+
+/*!
+ *  @brief  Sets where the register writes of attached drivers are streamed
+ *  @param  out Link to the standby, e.g. Serial1 or a socket
+ */
+void Adafruit_PWMMirror::setOutput(Print &out) { _out = &out; }
+
+/*!
+ *  @brief  Streams every later configuration and LED register write of a
+ * driver. Several drivers can share a mirror
+ *  @param  pwm The driver
+ */
+void Adafruit_PWMMirror::attach(Adafruit_PWMServoDriver &pwm) {
+  pwm._mirror = this;
+}
+
+/*!
+ *  @brief  Stops streaming the writes of a driver
+ *  @param  pwm The driver
+ */
+void Adafruit_PWMMirror::detach(Adafruit_PWMServoDriver &pwm) {
+  if (pwm._mirror == this)
+    pwm._mirror = NULL;
+}
+
+/*!
+ *  @brief  Reads MODE1, MODE2, PRESCALE and the LED registers of a chip and
+ * streams them, to bring a standby that started late up to date
+ *  @param  pwm The driver
+ *  @return success of the i2c reads
+ */
+bool Adafruit_PWMMirror::sendSnapshot(Adafruit_PWMServoDriver &pwm) {
+  uint8_t addr = pwm._i2caddr;
+  const uint8_t config[3] = {PCA9685_MODE1, PCA9685_MODE2, PCA9685_PRESCALE};
+  for (uint8_t i = 0; i < 3; i++) {
+    uint8_t buffer[2] = {config[i], pwm.read8(config[i])};
+    sent(addr, buffer, 2);
+  }
+
+  // Whole channels per read, within the bus buffer
+  uint8_t per_read =
+      min(pwm.i2c_dev->maxBufferSize(), (size_t)PWM_MIRROR_MAX_DATA) & ~3;
+  if (!per_read)
+    return false;
+  uint8_t buffer[1 + PWM_MIRROR_MAX_DATA];
+  for (uint8_t offset = 0; offset < 4 * PCA9685_NUM_CHANNELS;
+       offset += per_read) {
+    buffer[0] = PCA9685_LED0_ON_L + offset;
+    if (!pwm.i2c_dev->write_then_read(buffer, 1, buffer + 1, per_read))
+      return false;
+    sent(addr, buffer, 1 + per_read);
+  }
+  return true;
+}
+
+/*!
+ *  @brief  Sets where the standby receives the stream of the active
+ * controller
+ *  @param  in Link to the active controller
+ */
+void Adafruit_PWMMirror::setInput(Stream &in) { _in = &in; }
+
+/*!
+ *  @brief  Applies the received records to the shadow states. Call often on
+ * the standby, e.g. from loop()
+ *  @return number of records applied
+ */
+uint16_t Adafruit_PWMMirror::poll() {
+  uint16_t applied = 0;
+  if (!_in)
+    return 0;
+  while (_in->available() > 0) {
+    uint8_t c = _in->read();
+    if (!_rx_sync) {
+      _rx_sync = c == PWM_MIRROR_SYNC;
+      _rx_len = 0;
+      continue;
+    }
+    _rx[_rx_len++] = c;
+    if (_rx_len == 3 && _rx[2] > PWM_MIRROR_MAX_DATA) {
+      _errors++;
+      _rx_sync = false;
+      continue;
+    }
+    // Address, register, length, data and sum
+    if (_rx_len < 3 || _rx_len < 4 + _rx[2])
+      continue;
+    _rx_sync = false;
+    uint8_t sum = 0;
+    for (uint8_t i = 0; i < 3 + _rx[2]; i++)
+      sum += _rx[i];
+    if (sum != _rx[3 + _rx[2]]) {
+      _errors++;
+      continue;
+    }
+    apply(_rx);
+    applied++;
+  }
+  return applied;
+}
+
+/*!
+ *  @brief  Takes a chip over from the shadow state. If MODE1 and PRESCALE
+ * still match, only the LED registers that differ from the shadow are
+ * written, so the outputs never glitch. Otherwise the chip was reset: its
+ * configuration is restored and every known channel written
+ *  @param  pwm The driver of the chip, begun with beginBarebones() so the
+ * chip is not reset
+ *  @return false if the chip configuration is not in the shadow, then
+ * use begin(), else success of the i2c transfers
+ */
+bool Adafruit_PWMMirror::takeover(Adafruit_PWMServoDriver &pwm) {
+  pwm_mirror_state_t *st = slot(pwm._i2caddr, false);
+  if (!st || (st->config & (PWM_MIRROR_MODE1 | PWM_MIRROR_PRESCALE)) !=
+                 (PWM_MIRROR_MODE1 | PWM_MIRROR_PRESCALE))
+    return false;
+
+  bool success = true;
+  uint8_t mode1 = st->mode1 & ~MODE1_RESTART;
+  uint16_t diverged = st->known;
+  if ((pwm.read8(PCA9685_MODE1) & ~MODE1_RESTART) != mode1 ||
+      pwm.read8(PCA9685_PRESCALE) != st->prescale) {
+    success &= pwm.write8(PCA9685_MODE1, mode1 | MODE1_SLEEP);
+    success &= pwm.write8(PCA9685_PRESCALE, st->prescale);
+    success &= pwm.write8(PCA9685_MODE1, mode1);
+    if (!(mode1 & MODE1_SLEEP)) {
+      PCA9685_DELAY(5);
+      success &= pwm.write8(PCA9685_MODE1, mode1 | MODE1_RESTART);
+    }
+    pwm._us_factor = 0;
+    if (st->config & PWM_MIRROR_MODE2)
+      success &= pwm.write8(PCA9685_MODE2, st->mode2);
+  } else {
+    if ((st->config & PWM_MIRROR_MODE2) &&
+        pwm.read8(PCA9685_MODE2) != st->mode2)
+      success &= pwm.write8(PCA9685_MODE2, st->mode2);
+
+    uint8_t per_read =
+        min(pwm.i2c_dev->maxBufferSize(), (size_t)PWM_MIRROR_MAX_DATA) & ~3;
+    uint8_t buffer[PWM_MIRROR_MAX_DATA];
+    for (uint8_t offset = 0; per_read && offset < 4 * PCA9685_NUM_CHANNELS;
+         offset += per_read) {
+      uint8_t reg = PCA9685_LED0_ON_L + offset;
+      if (!pwm.i2c_dev->write_then_read(&reg, 1, buffer, per_read))
+        continue; // unreadable, rewrite these channels
+      for (uint8_t i = 0; i < per_read; i += 4) {
+        uint8_t num = (offset + i) / 4;
+        if (memcmp(&buffer[i], &st->leds[offset + i], 4) == 0)
+          diverged &= ~(1U << num);
+      }
+    }
+  }
+
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    const uint8_t *led = &st->leds[4 * num];
+    on[num] = led[0] | (uint16_t)led[1] << 8;
+    off[num] = led[2] | (uint16_t)led[3] << 8;
+  }
+  if (diverged)
+    success &= pwm.writeRuns(diverged, on, off);
+  return success;
+}
+
+/*!
+ *  @brief  Gets the shadow state of a chip
+ *  @param  addr 7 bit I2C address of the chip
+ *  @return the state, NULL if nothing was received for the chip
+ */
+const pwm_mirror_state_t *Adafruit_PWMMirror::state(uint8_t addr) const {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_states[i].addr == addr)
+      return &_states[i];
+  }
+  return NULL;
+}
+
+/*!
+ *  @brief  Streams a register write made by an attached driver
+ *  @param  addr 7 bit I2C address of the chip
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes, at most 65
+ */
+void Adafruit_PWMMirror::sent(uint8_t addr, const uint8_t *buffer,
+                              uint8_t len) {
+  if (!_out || len < 2 || len > 1 + PWM_MIRROR_MAX_DATA)
+    return;
+  uint8_t header[4] = {PWM_MIRROR_SYNC, addr, buffer[0], (uint8_t)(len - 1)};
+  uint8_t sum = header[1] + header[2] + header[3];
+  for (uint8_t i = 1; i < len; i++)
+    sum += buffer[i];
+  _out->write(header, sizeof(header));
+  _out->write(buffer + 1, len - 1);
+  _out->write(sum);
+}
+
+/*!
+ *  @brief  Applies a received record to the shadow of its chip
+ *  @param  record Address, register, length and register values
+ */
+void Adafruit_PWMMirror::apply(const uint8_t *record) {
+  pwm_mirror_state_t *st = slot(record[0], true);
+  if (!st) {
+    _errors++;
+    return;
+  }
+  const uint8_t *data = record + 3;
+  for (uint8_t i = 0; i < record[2]; i++) {
+    uint8_t reg = record[1] + i; // auto-increment
+    if (reg == PCA9685_MODE1) {
+      st->mode1 = data[i];
+      st->config |= PWM_MIRROR_MODE1;
+    } else if (reg == PCA9685_MODE2) {
+      st->mode2 = data[i];
+      st->config |= PWM_MIRROR_MODE2;
+    } else if (reg == PCA9685_PRESCALE) {
+      st->prescale = data[i];
+      st->config |= PWM_MIRROR_PRESCALE;
+    } else if (reg >= PCA9685_LED0_ON_L &&
+               reg < PCA9685_LED0_ON_L + 4 * PCA9685_NUM_CHANNELS) {
+      st->leds[reg - PCA9685_LED0_ON_L] = data[i];
+      st->known |= 1U << ((reg - PCA9685_LED0_ON_L) / 4);
+    } else if (reg >= PCA9685_ALLLED_ON_L && reg <= PCA9685_ALLLED_OFF_H) {
+      for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+        st->leds[4 * num + reg - PCA9685_ALLLED_ON_L] = data[i];
+      st->known = 0xFFFF;
+    }
+  }
+}
+
+/*!
+ *  @brief  Finds the state of a chip
+ *  @param  addr 7 bit I2C address of the chip
+ *  @param  claim Take a free slot if the chip has none
+ *  @return the state, NULL if not found or no slot is free
+ */
+pwm_mirror_state_t *Adafruit_PWMMirror::slot(uint8_t addr, bool claim) {
+  pwm_mirror_state_t *free_slot = NULL;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_states[i].addr == addr)
+      return &_states[i];
+    if (!_states[i].addr && !free_slot)
+      free_slot = &_states[i];
+  }
+  if (!claim || !free_slot)
+    return NULL;
+  free_slot->addr = addr;
+  free_slot->config = 0;
+  free_slot->known = 0;
+  return free_slot;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*!
+ *  @file Adafruit_PWMMirror.h
+ *
+ *  Register mirroring for redundant controllers. On the active controller
+ *  the mirror streams every configuration and LED register write of the
+ *  attached drivers to a serial port or socket. The standby controller
+ *  keeps a shadow of each chip from that stream and, on failover, takes
+ *  the chips over without a blackout: it checks MODE1 and PRESCALE, and
+ *  only rewrites the LED registers that differ from the shadow.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMMirror_H
+#define _ADAFRUIT_PWMMirror_H
+
+#include "Adafruit_PWMServoDriver.h"
+
+#define PWM_MIRROR_SYNC 0xA5     /**< First byte of every record */
+#define PWM_MIRROR_MAX_DATA 64   /**< Most register bytes in one record */
+#define PWM_MIRROR_MODE1 0x01    /**< MODE1 known, in pwm_mirror_state_t */
+#define PWM_MIRROR_MODE2 0x02    /**< MODE2 known, in pwm_mirror_state_t */
+#define PWM_MIRROR_PRESCALE 0x04 /**< PRESCALE known, in pwm_mirror_state_t */
+
+/*!
+ *  @brief  Shadow of the registers of one chip, kept by the standby
+ */
+typedef struct {
+  uint8_t addr;     ///< 7 bit I2C address, 0 for a free slot
+  uint8_t config;   ///< PWM_MIRROR_MODE1 etc. for the known registers
+  uint16_t known;   ///< Channels with known LED registers
+  uint8_t mode1;    ///< Last MODE1 written
+  uint8_t mode2;    ///< Last MODE2 written
+  uint8_t prescale; ///< Last PRESCALE written
+  uint8_t leds[4 * PCA9685_NUM_CHANNELS]; ///< LEDn_ON_L to LED15_OFF_H
+} pwm_mirror_state_t;
+
+/*!
+ *  @brief  Class that streams register writes to a standby controller, or
+ * receives them there and takes the chips over
+ */
+class Adafruit_PWMMirror {
+public:
+  Adafruit_PWMMirror(pwm_mirror_state_t *states = NULL, uint8_t count = 0);
+
+  // Active controller
+  void setOutput(Print &out);
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void detach(Adafruit_PWMServoDriver &pwm);
+  bool sendSnapshot(Adafruit_PWMServoDriver &pwm);
+
+  // Standby controller
+  void setInput(Stream &in);
+  uint16_t poll();
+  bool takeover(Adafruit_PWMServoDriver &pwm);
+  const pwm_mirror_state_t *state(uint8_t addr) const;
+
+  /*!
+   *  @brief  Records dropped for a bad checksum, or for a chip with no free
+   * state slot
+   *  @return dropped record count
+   */
+  uint32_t errors() const { return _errors; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+
+  void sent(uint8_t addr, const uint8_t *buffer, uint8_t len);
+  void apply(const uint8_t *record);
+  pwm_mirror_state_t *slot(uint8_t addr, bool claim);
+
+  Print *_out;
+  Stream *_in;
+  pwm_mirror_state_t *_states;
+  uint8_t _count;
+  uint8_t _rx[4 + PWM_MIRROR_MAX_DATA]; // record after the sync byte
+  uint8_t _rx_len;
+  bool _rx_sync; // sync byte seen, receiving a record
+  uint32_t _errors;
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*!
+ *  @file Adafruit_PWMPose.cpp
+ *
+ *  Weighted pose blending. The weights are normalized once per blend into
+ *  0.16 fixed point so the per-channel work is a multiply-accumulate over
+ *  the selected poses followed by a shift, with no division or floating
+ *  point. The accumulation runs over a plain array of 16 channels with no
+ *  data-dependent branches, which lets compilers vectorize it on hosts with
+ *  SIMD. Results are written straight into the frame for a batched flush.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMPose.h"
+
+/*!
+ *  @brief  Instantiates a pose store over a table of poses
+ *  @param  poses Array of poses, must stay valid while the store is used
+ *  @param  count Number of poses in the array
+ *  @param  progmem If true, the table lives in PROGMEM
+ */
+Adafruit_PWMPoseStore::Adafruit_PWMPoseStore(const pwm_pose_t *poses,
+                                             uint8_t count, bool progmem)
+    : _poses(poses), _count(count), _progmem(progmem) {}
+
+/*!
+ *  @brief  Reads one channel of a stored pose
+ *  @param  pose Index of the pose
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @return OFF tick value, 0 if pose or num is out of range
+ */
+uint16_t Adafruit_PWMPoseStore::get(uint8_t pose, uint8_t num) const {
+  if (pose >= _count || num >= PCA9685_NUM_CHANNELS)
+    return 0;
+  if (_progmem)
+    return pgm_read_word(&_poses[pose][num]);
+  return _poses[pose][num];
+}
+
+/*!
+ *  @brief  Writes a stored pose into a frame
+ *  @param  frame The frame that receives the pose
+ *  @param  pose Index of the pose
+ *  @param  mask Channels to write, one bit per channel
+ */
+void Adafruit_PWMPoseStore::apply(Adafruit_PWMFrame &frame, uint8_t pose,
+                                  uint16_t mask) const {
+  if (pose >= _count)
+    return;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (mask & (1U << num))
+      frame.setPWM(num, 0, get(pose, num));
+  }
+}
+
+/*!
+ *  @brief  Blends several stored poses by weight and writes the result into
+ * a frame, e.g. poses {WALK, TURN} with weights {70, 30}
+ *  @param  frame The frame that receives the blended pose
+ *  @param  poses Array of 'n' pose indices
+ *  @param  weights Array of 'n' relative weights, any scale
+ *  @param  n Number of poses to blend, up to PWM_POSE_MAX_BLEND
+ *  @param  mask Channels to write, one bit per channel
+ */
+void Adafruit_PWMPoseStore::blend(Adafruit_PWMFrame &frame,
+                                  const uint8_t *poses,
+                                  const uint16_t *weights, uint8_t n,
+                                  uint16_t mask) const {
+  n = min(n, (uint8_t)PWM_POSE_MAX_BLEND);
+
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (poses[i] < _count)
+      total += weights[i];
+  }
+  if (!total)
+    return;
+
+  // Normalize once so the weights sum to 1.0 in 0.16 fixed point
+  uint32_t w[PWM_POSE_MAX_BLEND];
+  for (uint8_t i = 0; i < n; i++) {
+    w[i] = poses[i] < _count ? ((uint32_t)weights[i] << 16) / total : 0;
+  }
+
+  // 4095 * 65536 fits comfortably in 32 bits
+  uint32_t acc[PCA9685_NUM_CHANNELS];
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+    acc[num] = 1UL << 15;
+
+  for (uint8_t i = 0; i < n; i++) {
+    if (!w[i])
+      continue;
+    const uint16_t *pose = _poses[poses[i]];
+    uint32_t wi = w[i];
+    if (_progmem) {
+      for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+        acc[num] += wi * pgm_read_word(&pose[num]);
+    } else {
+      for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+        acc[num] += wi * pose[num];
+    }
+  }
+
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (mask & (1U << num))
+      frame.setPWM(num, 0, min(acc[num] >> 16, (uint32_t)4095));
+  }
+}
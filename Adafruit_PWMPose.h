@@ -0,0 +1,44 @@
+/*!
+ *  @file Adafruit_PWMPose.h
+ *
+ *  Stored servo poses for one PCA9685 and weighted blending between them.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMPose_H
+#define _ADAFRUIT_PWMPose_H
+
+#include "Adafruit_PWMFrame.h"
+
+/** One pose, the OFF tick of every channel of a chip */
+typedef uint16_t pwm_pose_t[PCA9685_NUM_CHANNELS];
+
+#define PWM_POSE_MAX_BLEND 8 /**< Maximum number of poses in one blend */
+
+/*!
+ *  @brief  Class that holds a table of poses, in RAM or PROGMEM, and blends
+ * them into a frame
+ */
+class Adafruit_PWMPoseStore {
+public:
+  Adafruit_PWMPoseStore(const pwm_pose_t *poses, uint8_t count,
+                        bool progmem = false);
+
+  /*!
+   *  @brief  Number of poses in the store
+   *  @return pose count
+   */
+  uint8_t count() const { return _count; }
+  uint16_t get(uint8_t pose, uint8_t num) const;
+  void apply(Adafruit_PWMFrame &frame, uint8_t pose,
+             uint16_t mask = 0xFFFF) const;
+  void blend(Adafruit_PWMFrame &frame, const uint8_t *poses,
+             const uint16_t *weights, uint8_t n, uint16_t mask = 0xFFFF) const;
+
+private:
+  const pwm_pose_t *_poses;
+  uint8_t _count;
+  bool _progmem;
+};
+
+#endif
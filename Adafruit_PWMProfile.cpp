@@ -0,0 +1,64 @@
+/*!
+ *  @file Adafruit_PWMProfile.cpp
+ *
+ *  Per phase totals for the driver profiling scopes.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMProfile.h"
+
+static const char *const scope_names[PWM_PROFILE_SCOPES] = {
+    "encode", "bus write", "bus read", "wait"};
+
+pwm_profile_t Adafruit_PWMProfile::_scopes[PWM_PROFILE_SCOPES];
+
+/*!
+ *  @brief  Starts the cycle counter where it has to be enabled and clears
+ * the totals, call once from setup()
+ */
+void Adafruit_PWMProfile::begin() {
+#ifdef PCA9685_PROFILE_DWT
+  *(volatile uint32_t *)0xE000EDFC |= 1UL << 24; // DEMCR.TRCENA
+  *(volatile uint32_t *)0xE0001004 = 0;          // DWT_CYCCNT
+  *(volatile uint32_t *)0xE0001000 |= 1UL;       // DWT_CTRL.CYCCNTENA
+#endif
+  reset();
+}
+
+/*!
+ *  @brief  Clears the totals of every phase
+ */
+void Adafruit_PWMProfile::reset() {
+  for (uint8_t i = 0; i < PWM_PROFILE_SCOPES; i++) {
+    _scopes[i].count = 0;
+    _scopes[i].max = 0;
+    _scopes[i].total = 0;
+  }
+}
+
+/*!
+ *  @brief  Gets the totals of one phase
+ *  @param  scope One of pwm_profile_scope_t
+ *  @return accumulated totals
+ */
+const pwm_profile_t &Adafruit_PWMProfile::get(uint8_t scope) {
+  return _scopes[scope];
+}
+
+/*!
+ *  @brief  Prints one line per phase: passes, mean and maximum
+ *  @param  out Where to print, e.g. Serial
+ */
+void Adafruit_PWMProfile::report(Print &out) {
+  for (uint8_t i = 0; i < PWM_PROFILE_SCOPES; i++) {
+    const pwm_profile_t *p = &_scopes[i];
+    out.print(scope_names[i]);
+    out.print(": count ");
+    out.print((unsigned long)p->count);
+    out.print(" mean ");
+    out.print((unsigned long)(p->count ? p->total / p->count : 0));
+    out.print(" max ");
+    out.println((unsigned long)p->max);
+  }
+}
@@ -0,0 +1,127 @@
+/*!
+ *  @file Adafruit_PWMProfile.h
+ *
+ *  Optional cycle counter profiling of the driver hot paths. Build with
+ *  PCA9685_ENABLE_PROFILING to time every encode, bus write, bus read and
+ *  wait phase; without it the scopes compile to nothing.
+ *
+ *  Counter units depend on the target: CPU cycles on Cortex-M3/M4/M7 (DWT
+ *  CYCCNT) and x86 (TSC), nanoseconds on other Linux targets and
+ *  microseconds everywhere else. Phases can nest: the first conversion
+ *  after a frequency change also counts the prescale read as encode time.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMProfile_H
+#define _ADAFRUIT_PWMProfile_H
+
+#include <Arduino.h>
+
+#include "Adafruit_PWMServoDriver_config.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) ||                  \
+    defined(__ARM_ARCH_8M_MAIN__)
+#define PCA9685_PROFILE_DWT /**< Cortex-M data watchpoint cycle counter */
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PCA9685_PROFILE_TSC /**< x86 time stamp counter */
+#elif defined(__linux__)
+#include <time.h>
+#define PCA9685_PROFILE_CLOCK /**< Linux monotonic clock */
+#endif
+
+/*!
+ *  @brief  Profiled phases of the driver
+ */
+typedef enum {
+  PWM_PROFILE_ENCODE,    ///< Building register payloads and tick values
+  PWM_PROFILE_BUS_WRITE, ///< I2C writes
+  PWM_PROFILE_BUS_READ,  ///< I2C register reads
+  PWM_PROFILE_WAIT,      ///< Waiting for the chip oscillator
+  PWM_PROFILE_SCOPES     ///< Number of phases
+} pwm_profile_scope_t;
+
+/*!
+ *  @brief  Accumulated time of one phase, in counter units
+ */
+typedef struct {
+  uint32_t count; ///< Times the phase was entered
+  uint32_t max;   ///< Longest single pass
+  uint64_t total; ///< Sum of all passes
+} pwm_profile_t;
+
+/*!
+ *  @brief  Class that holds the per phase profiling totals
+ */
+class Adafruit_PWMProfile {
+public:
+  static void begin();
+  static void reset();
+  static const pwm_profile_t &get(uint8_t scope);
+  static void report(Print &out);
+
+  /*!
+   *  @brief  Adds one pass of a phase to its totals
+   *  @param  scope One of pwm_profile_scope_t
+   *  @param  elapsed Length of the pass in counter units
+   */
+  static void add(uint8_t scope, uint32_t elapsed) {
+    pwm_profile_t *p = &_scopes[scope];
+    p->count++;
+    p->total += elapsed;
+    if (elapsed > p->max)
+      p->max = elapsed;
+  }
+
+  /*!
+   *  @brief  Reads the profiling counter
+   *  @return counter value, wraps around
+   */
+  static uint32_t now() {
+#if defined(PCA9685_PROFILE_DWT)
+    return *(volatile uint32_t *)0xE0001004; // DWT_CYCCNT
+#elif defined(PCA9685_PROFILE_TSC)
+    return (uint32_t)__rdtsc();
+#elif defined(PCA9685_PROFILE_CLOCK)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+#else
+    return micros();
+#endif
+  }
+
+private:
+  static pwm_profile_t _scopes[PWM_PROFILE_SCOPES];
+};
+
+/*!
+ *  @brief  Times the enclosing block as one pass of a phase
+ */
+class Adafruit_PWMProfileScope {
+public:
+  /*!
+   *  @brief  Starts timing
+   *  @param  scope One of pwm_profile_scope_t
+   */
+  Adafruit_PWMProfileScope(uint8_t scope)
+      : _scope(scope), _start(Adafruit_PWMProfile::now()) {}
+  ~Adafruit_PWMProfileScope() {
+    Adafruit_PWMProfile::add(_scope, Adafruit_PWMProfile::now() - _start);
+  }
+
+private:
+  uint8_t _scope;
+  uint32_t _start;
+};
+
+#ifdef PCA9685_ENABLE_PROFILING
+/** Times the rest of the enclosing block as one pass of 'scope' */
+#define PCA9685_PROFILE(scope) Adafruit_PWMProfileScope _pca9685_profile(scope)
+#else
+#define PCA9685_PROFILE(scope)                                                 \
+  do {                                                                         \
+  } while (0) /**< Profiling disabled */
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+/*!
+ *  @file Adafruit_PWMScheduler.cpp
+ *
+ *  Hashed timer wheel. Events hash by due millisecond into one of
+ *  PWM_WHEEL_SLOTS doubly linked lists, with a count of whole wheel turns
+ *  to wait, so inserting and cancelling are constant time whatever the
+ *  number of pending events. update() walks one slot per elapsed
+ *  millisecond, applies every due event to its frame and then flushes each
+ *  touched chip once per millisecond, so events due together go out in the
+ *  same bursts, while a short pulse processed late still reaches the chip
+ *  instead of collapsing into its final state.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMScheduler.h"
+
+#define SLOT_FREE 0xFF
+
+/*!
+ *  @brief  Instantiates a scheduler over an application provided event pool
+ *  @param  pool Array of events, must stay valid while the scheduler is used
+ *  @param  size Number of events in the pool, at most PWM_EVENT_NONE - 1
+ */
+Adafruit_PWMScheduler::Adafruit_PWMScheduler(pwm_event_t *pool, uint16_t size)
+    : _pool(pool), _size(size), _free(PWM_EVENT_NONE), _pending(0),
+      _tick(0) {
+  for (uint16_t i = 0; i < PWM_WHEEL_SLOTS; i++)
+    _head[i] = PWM_EVENT_NONE;
+  for (uint16_t i = size; i-- > 0;) {
+    _pool[i].slot = SLOT_FREE;
+    _pool[i].next = _free;
+    _free = i;
+  }
+}
+
+/*!
+ *  @brief  Sets the current time, call once before scheduling
+ *  @param  now Current time in milliseconds, typically millis()
+ */
+void Adafruit_PWMScheduler::begin(uint32_t now) { _tick = now; }
+
+/*!
+ *  @brief  Schedules a channel change
+ *  @param  at Time to apply the change in milliseconds, times in the past
+ * are applied on the next update()
+ *  @param  frame Frame of the chip the channel is on
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  on ON tick to set
+ *  @param  off OFF tick to set
+ *  @return handle for cancel(), PWM_EVENT_NONE if the pool is exhausted
+ */
+uint16_t Adafruit_PWMScheduler::schedule(uint32_t at, Adafruit_PWMFrame &frame,
+                                         uint8_t num, uint16_t on,
+                                         uint16_t off) {
+  uint16_t handle = _free;
+  if (handle == PWM_EVENT_NONE)
+    return PWM_EVENT_NONE;
+  pwm_event_t *e = &_pool[handle];
+  _free = e->next;
+
+  // Due times at or before the last processed tick go in the next slot
+  int32_t delay = (int32_t)(at - _tick);
+  if (delay < 1)
+    delay = 1;
+  uint32_t due = _tick + delay;
+
+  e->frame = &frame;
+  e->num = num;
+  e->on = on;
+  e->off = off;
+  e->rounds = (delay - 1) >> PWM_WHEEL_BITS;
+  e->slot = due & (PWM_WHEEL_SLOTS - 1);
+  e->prev = PWM_EVENT_NONE;
+  e->next = _head[e->slot];
+  if (e->next != PWM_EVENT_NONE)
+    _pool[e->next].prev = handle;
+  _head[e->slot] = handle;
+  _pending++;
+  return handle;
+}
+
+/*!
+ *  @brief  Schedules a channel change, see Adafruit_PWMServoDriver::setPin()
+ *  @param  at Time to apply the change in milliseconds
+ *  @param  frame Frame of the chip the channel is on
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  val The number of ticks out of 4096 to be active
+ *  @param  invert If true, inverts the output, defaults to 'false'
+ *  @return handle for cancel(), PWM_EVENT_NONE if the pool is exhausted
+ */
+uint16_t Adafruit_PWMScheduler::schedulePin(uint32_t at,
+                                            Adafruit_PWMFrame &frame,
+                                            uint8_t num, uint16_t val,
+                                            bool invert) {
+  uint16_t on, off;
+  Adafruit_PWMServoDriver::pinToPWM(val, invert, &on, &off);
+  return schedule(at, frame, num, on, off);
+}
+
+/*!
+ *  @brief  Schedules a one-shot pulse: the channel is set to 'val' at 'at'
+ * and fully off 'length' milliseconds later
+ *  @param  at Start of the pulse in milliseconds
+ *  @param  length Length of the pulse in milliseconds, at least 1
+ *  @param  frame Frame of the chip the channel is on
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  val Level during the pulse, defaults to fully on
+ *  @return true if both edges were scheduled
+ */
+bool Adafruit_PWMScheduler::pulse(uint32_t at, uint32_t length,
+                                  Adafruit_PWMFrame &frame, uint8_t num,
+                                  uint16_t val) {
+  uint16_t start = schedulePin(at, frame, num, val);
+  if (start == PWM_EVENT_NONE)
+    return false;
+  if (schedulePin(at + max(length, (uint32_t)1), frame, num, 0) ==
+      PWM_EVENT_NONE) {
+    cancel(start);
+    return false;
+  }
+  return true;
+}
+
+/*!
+ *  @brief  Cancels a pending event
+ *  @param  handle Handle returned when the event was scheduled
+ *  @return true if the event was pending
+ */
+bool Adafruit_PWMScheduler::cancel(uint16_t handle) {
+  if (handle >= _size || _pool[handle].slot == SLOT_FREE)
+    return false;
+  unlink(handle);
+  return true;
+}
+
+/*!
+ *  @brief  Applies every event due up to the given time. The chips touched
+ * in each elapsed millisecond are flushed before the next one is processed
+ *  @param  now Current time in milliseconds, typically millis()
+ *  @return success of all frame flushes
+ */
+bool Adafruit_PWMScheduler::update(uint32_t now) {
+  Adafruit_PWMFrame *touched[PWM_SCHEDULER_MAX_FRAMES];
+  uint8_t ntouched = 0;
+  bool success = true;
+
+  while ((int32_t)(now - _tick) > 0) {
+    if (!_pending) {
+      _tick = now;
+      break;
+    }
+    _tick++;
+    uint16_t handle = _head[_tick & (PWM_WHEEL_SLOTS - 1)];
+    while (handle != PWM_EVENT_NONE) {
+      pwm_event_t *e = &_pool[handle];
+      uint16_t next = e->next;
+      if (e->rounds) {
+        e->rounds--;
+      } else {
+        e->frame->setPWM(e->num, e->on, e->off);
+        uint8_t i = 0;
+        while (i < ntouched && touched[i] != e->frame)
+          i++;
+        if (i == ntouched) {
+          if (ntouched < PWM_SCHEDULER_MAX_FRAMES)
+            touched[ntouched++] = e->frame;
+          else
+            success &= e->frame->flush();
+        }
+        unlink(handle);
+      }
+      handle = next;
+    }
+
+    for (uint8_t i = 0; i < ntouched; i++)
+      success &= touched[i]->flush();
+    ntouched = 0;
+  }
+  return success;
+}
+
+/*!
+ *  @brief  Removes an event from its slot and returns it to the free list
+ *  @param  handle The event to remove
+ */
+void Adafruit_PWMScheduler::unlink(uint16_t handle) {
+  pwm_event_t *e = &_pool[handle];
+  if (e->prev != PWM_EVENT_NONE)
+    _pool[e->prev].next = e->next;
+  else
+    _head[e->slot] = e->next;
+  if (e->next != PWM_EVENT_NONE)
+    _pool[e->next].prev = e->prev;
+
+  e->slot = SLOT_FREE;
+  e->next = _free;
+  _free = handle;
+  _pending--;
+}
@@ -0,0 +1,68 @@
+/*!
+ *  @file Adafruit_PWMScheduler.h
+ *
+ *  Timer-wheel scheduler for timed channel changes and pulses.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMScheduler_H
+#define _ADAFRUIT_PWMScheduler_H
+
+#include "Adafruit_PWMFrame.h"
+
+#define PWM_WHEEL_BITS 6                     /**< log2 of the wheel size */
+#define PWM_WHEEL_SLOTS (1 << PWM_WHEEL_BITS) /**< Slots, one per ms */
+#define PWM_EVENT_NONE 0xFFFF /**< Handle of no event / end of list */
+#define PWM_SCHEDULER_MAX_FRAMES 8 /**< Frames flushed together per update */
+
+/*!
+ *  @brief  One pending channel change, storage is provided by the
+ * application and managed by the scheduler
+ */
+typedef struct {
+  Adafruit_PWMFrame *frame; ///< Frame of the chip the channel is on
+  uint32_t rounds;          ///< Wheel turns left before the event is due
+  uint16_t next;            ///< Next event in the same slot or free list
+  uint16_t prev;            ///< Previous event in the same slot
+  uint16_t on;              ///< ON tick to set
+  uint16_t off;             ///< OFF tick to set
+  uint8_t num;              ///< Channel to set
+  uint8_t slot;             ///< Wheel slot, 0xFF while free
+} pwm_event_t;
+
+/*!
+ *  @brief  Class that applies channel changes at given times, with
+ * constant time insert and cancel
+ */
+class Adafruit_PWMScheduler {
+public:
+  Adafruit_PWMScheduler(pwm_event_t *pool, uint16_t size);
+
+  void begin(uint32_t now);
+  uint16_t schedule(uint32_t at, Adafruit_PWMFrame &frame, uint8_t num,
+                    uint16_t on, uint16_t off);
+  uint16_t schedulePin(uint32_t at, Adafruit_PWMFrame &frame, uint8_t num,
+                       uint16_t val, bool invert = false);
+  bool pulse(uint32_t at, uint32_t length, Adafruit_PWMFrame &frame,
+             uint8_t num, uint16_t val = 4095);
+  bool cancel(uint16_t handle);
+  bool update(uint32_t now);
+
+  /*!
+   *  @brief  Number of events waiting to be applied
+   *  @return pending event count
+   */
+  uint16_t pending() const { return _pending; }
+
+private:
+  void unlink(uint16_t handle);
+
+  pwm_event_t *_pool;
+  uint16_t _size;
+  uint16_t _free;
+  uint16_t _pending;
+  uint32_t _tick; // last processed millisecond
+  uint16_t _head[PWM_WHEEL_SLOTS];
+};
+
+#endif
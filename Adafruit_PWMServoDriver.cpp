@@ -28,8 +28,15 @@
  */
 
 #include "Adafruit_PWMServoDriver.h"
-
-//#define ENABLE_DEBUG_OUTPUT
+#include "Adafruit_PWMBus.h"
+#include "Adafruit_PWMCombiner.h"
+#include "Adafruit_PWMCompletions.h"
+#include "Adafruit_PWMDebugLog.h"
+#include "Adafruit_PWMDrift.h"
+#include "Adafruit_PWMMirror.h"
+#include "Adafruit_PWMProfile.h"
+#include "Adafruit_PWMTiming.h"
+#include "Adafruit_PWMTrace.h"
 
 /*!
  *  @brief  Instantiates a new PCA9685 PWM driver chip with the I2C address on a
@@ -87,7 +94,11 @@ bool Adafruit_PWMServoDriver::begin(uint8_t prescale) {
  */
 void Adafruit_PWMServoDriver::reset() {
   write8(PCA9685_MODE1, MODE1_RESTART);
-  delay(10);
+  {
+    PCA9685_PROFILE(PWM_PROFILE_WAIT);
+    PCA9685_DELAY(10);
+  }
+  _us_factor = 0;
 }
 
 /*!
@@ -97,7 +108,8 @@ void Adafruit_PWMServoDriver::sleep() {
   uint8_t awake = read8(PCA9685_MODE1);
   uint8_t sleep = awake | MODE1_SLEEP; // set sleep bit high
   write8(PCA9685_MODE1, sleep);
-  delay(5); // wait until cycle ends for sleep to be active
+  PCA9685_PROFILE(PWM_PROFILE_WAIT);
+  PCA9685_DELAY(5); // wait until cycle ends for sleep to be active
 }
 
 /*!
@@ -117,33 +129,34 @@ void Adafruit_PWMServoDriver::wakeup() {
 void Adafruit_PWMServoDriver::setExtClk(uint8_t prescale) {
   uint8_t oldmode = read8(PCA9685_MODE1);
   uint8_t newmode = (oldmode & ~MODE1_RESTART) | MODE1_SLEEP; // sleep
-  write8(PCA9685_MODE1, newmode); // go to sleep, turn off internal oscillator
+  bool success =
+      write8(PCA9685_MODE1, newmode); // go to sleep, turn off internal osc
 
   // This sets both the SLEEP and EXTCLK bits of the MODE1 register to switch to
   // use the external clock.
-  write8(PCA9685_MODE1, (newmode |= MODE1_EXTCLK));
+  success &= write8(PCA9685_MODE1, (newmode |= MODE1_EXTCLK));
 
-  write8(PCA9685_PRESCALE, prescale); // set the prescaler
+  success &= write8(PCA9685_PRESCALE, prescale); // set the prescaler
+  _us_factor = 0;
 
-  delay(5);
+  {
+    PCA9685_PROFILE(PWM_PROFILE_WAIT);
+    PCA9685_DELAY(5);
+  }
   // clear the SLEEP bit to start
-  write8(PCA9685_MODE1, (newmode & ~MODE1_SLEEP) | MODE1_RESTART | MODE1_AI);
-
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Mode now 0x");
-  Serial.println(read8(PCA9685_MODE1), HEX);
-#endif
+  success &= write8(PCA9685_MODE1,
+                    (newmode & ~MODE1_SLEEP) | MODE1_RESTART | MODE1_AI);
+  PCA9685_LOG(PWM_LOG_MODE1,
+              (newmode & ~MODE1_SLEEP) | MODE1_RESTART | MODE1_AI, 0, 0);
+  complete(PWM_DONE_CONFIG, prescale, success);
 }
 
 /*!
  *  @brief  Sets the PWM frequency for the entire chip, up to ~1.6 KHz
- *  @param  freq Floating point frequency that we will attempt to match
+ *  @param  freq Frequency that we will attempt to match, integer Hz when
+ * built with PCA9685_NO_FLOAT
  */
-void Adafruit_PWMServoDriver::setPWMFreq(float freq) {
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Attempting to set freq ");
-  Serial.println(freq);
-#endif
+void Adafruit_PWMServoDriver::setPWMFreq(pca9685_freq_t freq) {
   // Range output modulation frequency is dependant on oscillator
   if (freq < 1)
     freq = 1;
@@ -151,25 +164,22 @@ void Adafruit_PWMServoDriver::setPWMFreq(float freq) {
     freq = 3500; // Datasheet limit is 3052=50MHz/(4*4096)
 
   uint8_t prescale = calcPrescale(freq);
-
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Final pre-scale: ");
-  Serial.println(prescale);
-#endif
+  PCA9685_LOG(PWM_LOG_FREQ, prescale, (uint16_t)freq, 0);
 
   uint8_t oldmode = read8(PCA9685_MODE1);
   uint8_t newmode = (oldmode & ~MODE1_RESTART) | MODE1_SLEEP; // sleep
-  write8(PCA9685_MODE1, newmode);                             // go to sleep
-  write8(PCA9685_PRESCALE, prescale); // set the prescaler
-  write8(PCA9685_MODE1, oldmode);
-  delay(5);
+  bool success = write8(PCA9685_MODE1, newmode);             // go to sleep
+  success &= write8(PCA9685_PRESCALE, prescale); // set the prescaler
+  _us_factor = 0;
+  success &= write8(PCA9685_MODE1, oldmode);
+  {
+    PCA9685_PROFILE(PWM_PROFILE_WAIT);
+    PCA9685_DELAY(5);
+  }
   // This sets the MODE1 register to turn on auto increment.
-  write8(PCA9685_MODE1, oldmode | MODE1_RESTART | MODE1_AI);
-
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Mode now 0x");
-  Serial.println(read8(PCA9685_MODE1), HEX);
-#endif
+  success &= write8(PCA9685_MODE1, oldmode | MODE1_RESTART | MODE1_AI);
+  PCA9685_LOG(PWM_LOG_MODE1, oldmode | MODE1_RESTART | MODE1_AI, 0, 0);
+  complete(PWM_DONE_CONFIG, prescale, success);
 }
 
 /*!
@@ -187,13 +197,9 @@ void Adafruit_PWMServoDriver::setOutputMode(bool totempole) {
   } else {
     newmode = oldmode & ~MODE2_OUTDRV;
   }
-  write8(PCA9685_MODE2, newmode);
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Setting output mode: ");
-  Serial.print(totempole ? "totempole" : "open drain");
-  Serial.print(" by setting MODE2 to ");
-  Serial.println(newmode);
-#endif
+  bool success = write8(PCA9685_MODE2, newmode);
+  PCA9685_LOG(PWM_LOG_MODE2, newmode, 0, 0);
+  complete(PWM_DONE_CONFIG, newmode, success);
 }
 
 /*!
@@ -211,11 +217,22 @@ uint8_t Adafruit_PWMServoDriver::readPrescale(void) {
  *  @return requested PWM output value
  */
 uint16_t Adafruit_PWMServoDriver::getPWM(uint8_t num, bool off) {
+#ifndef PCA9685_NO_COMBINER
+  // Read what was written, not what the chip had before the window
+  if (_combiner)
+    _combiner->flush();
+#endif
   uint8_t buffer[2] = {uint8_t(PCA9685_LED0_ON_L + 4 * num), 0};
   if (off)
     buffer[0] += 2;
-  i2c_dev->write_then_read(buffer, 1, buffer, 2);
-  return uint16_t(buffer[0]) | (uint16_t(buffer[1]) << 8);
+  bool success;
+  {
+    PCA9685_PROFILE(PWM_PROFILE_BUS_READ);
+    success = i2c_dev->write_then_read(buffer, 1, buffer, 2);
+  }
+  uint16_t value = uint16_t(buffer[0]) | (uint16_t(buffer[1]) << 8);
+  complete(PWM_DONE_READ, value, success);
+  return value;
 }
 
 /*!
@@ -227,22 +244,33 @@ uint16_t Adafruit_PWMServoDriver::getPWM(uint8_t num, bool off) {
  */
 bool Adafruit_PWMServoDriver::setPWM(uint8_t num, uint16_t on,
                                         uint16_t off) {
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Setting PWM ");
-  Serial.print(num);
-  Serial.print(": ");
-  Serial.print(on);
-  Serial.print("->");
-  Serial.println(off);
+  PCA9685_TRACE_ENTRY();
+  PCA9685_LOG(PWM_LOG_SET_PWM, num, on, off);
+  if (num < PCA9685_NUM_CHANNELS)
+    writing(1U << num);
+#ifndef PCA9685_NO_BATCH
+  if (_batch && num < PCA9685_NUM_CHANNELS) {
+    _batch->set(num, on, off);
+    return true;
+  }
+#endif
+#ifndef PCA9685_NO_COMBINER
+  if (_combiner && num < PCA9685_NUM_CHANNELS) {
+    _combiner->set(num, on, off);
+    return true;
+  }
 #endif
 
   uint8_t buffer[5];
-  buffer[0] = PCA9685_LED0_ON_L + 4 * num;
-  buffer[1] = on;
-  buffer[2] = on >> 8;
-  buffer[3] = off;
-  buffer[4] = off >> 8;
-  return i2c_dev->write(buffer, 5);
+  {
+    PCA9685_PROFILE(PWM_PROFILE_ENCODE);
+    buffer[0] = PCA9685_LED0_ON_L + 4 * num;
+    buffer[1] = on;
+    buffer[2] = on >> 8;
+    buffer[3] = off;
+    buffer[4] = off >> 8;
+  }
+  return writeLEDs(buffer, 5);
 }
 
 /*!
@@ -257,34 +285,244 @@ bool Adafruit_PWMServoDriver::setPWM(uint8_t num, uint16_t on,
  *   @return setPWM response, i.e. success of i2c write
  */
 bool Adafruit_PWMServoDriver::setPin(uint8_t num, uint16_t val, bool invert) {
+  PCA9685_TRACE_ENTRY();
+  uint16_t on, off;
+  pinToPWM(val, invert, &on, &off);
+  return setPWM(num, on, off);
+}
+
+/*!
+ *  @brief  Sets the PWM output of a run of consecutive PCA9685 pins using
+ * auto-increment, splitting the run into as few I2C writes as the bus buffer
+ * allows
+ *  @param  first The first PWM output pin of the run, from 0 to 15
+ *  @param  count Number of consecutive pins to write
+ *  @param  on Array of 'count' ON tick values
+ *  @param  off Array of 'count' OFF tick values
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::setPWMBurst(uint8_t first, uint8_t count,
+                                          const uint16_t *on,
+                                          const uint16_t *off) {
+  PCA9685_TRACE_ENTRY();
+  if (first + count > PCA9685_NUM_CHANNELS)
+    return false;
+  writing((uint16_t)(((1UL << count) - 1) << first));
+  return writeBurst(first, count, on, off);
+}
+
+/*!
+ *  @brief  Sends a run of consecutive pins, or hands it to the attached
+ * batch or combiner, without telling the oscillator tracker: for writes
+ * it already knows about
+ *  @param  first The first PWM output pin of the run, from 0 to 15
+ *  @param  count Number of consecutive pins, first + count at most 16
+ *  @param  on Array of 'count' ON tick values
+ *  @param  off Array of 'count' OFF tick values
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::writeBurst(uint8_t first, uint8_t count,
+                                         const uint16_t *on,
+                                         const uint16_t *off) {
+  PCA9685_LOG(PWM_LOG_BURST, first, count, 0);
+#ifndef PCA9685_NO_BATCH
+  if (_batch) {
+    for (uint8_t i = 0; i < count; i++)
+      _batch->set(first + i, on[i], off[i]);
+    return true;
+  }
+#endif
+#ifndef PCA9685_NO_COMBINER
+  if (_combiner) {
+    for (uint8_t i = 0; i < count; i++)
+      _combiner->set(first + i, on[i], off[i]);
+    return true;
+  }
+#endif
+
+  // Whole channels only, one byte is taken by the register address
+  uint8_t per_write = (min(i2c_dev->maxBufferSize(),
+                           (size_t)(1 + 4 * PCA9685_NUM_CHANNELS)) -
+                       1) /
+                      4;
+  if (per_write == 0)
+    return false;
+
+  uint8_t buffer[1 + 4 * PCA9685_NUM_CHANNELS];
+  bool success = true;
+  while (count) {
+    uint8_t n = min(count, per_write);
+    uint8_t *p = buffer;
+    {
+      PCA9685_PROFILE(PWM_PROFILE_ENCODE);
+      *p++ = PCA9685_LED0_ON_L + 4 * first;
+      for (uint8_t i = 0; i < n; i++) {
+        *p++ = on[i];
+        *p++ = on[i] >> 8;
+        *p++ = off[i];
+        *p++ = off[i] >> 8;
+      }
+    }
+    success &= writeLEDs(buffer, p - buffer);
+    first += n;
+    on += n;
+    off += n;
+    count -= n;
+  }
+  return success;
+}
+
+/*!
+ *  @brief  Sets the same PWM output on any set of PCA9685 pins in as few I2C
+ * writes as possible: one ALL_LED write when every pin is selected, otherwise
+ * one burst per run of consecutive pins
+ *  @param  mask Pins to write, one bit per pin, bit 0 is pin 0
+ *  @param  on At what point in the 4096-part cycle to turn the outputs ON
+ *  @param  off At what point in the 4096-part cycle to turn the outputs OFF
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::setPWMMask(uint16_t mask, uint16_t on,
+                                         uint16_t off) {
+  PCA9685_TRACE_ENTRY();
+  writing(mask);
+  // Collected writes keep their per channel values, so only write ALL_LED
+  // when nothing is held back
+  bool held = false;
+#ifndef PCA9685_NO_BATCH
+  held |= _batch != NULL;
+#endif
+#ifndef PCA9685_NO_COMBINER
+  held |= _combiner != NULL;
+#endif
+  if (mask == 0xFFFF && !held) {
+    PCA9685_LOG(PWM_LOG_BURST, 0, PCA9685_NUM_CHANNELS, 0);
+    uint8_t buffer[5];
+    {
+      PCA9685_PROFILE(PWM_PROFILE_ENCODE);
+      buffer[0] = PCA9685_ALLLED_ON_L;
+      buffer[1] = on;
+      buffer[2] = on >> 8;
+      buffer[3] = off;
+      buffer[4] = off >> 8;
+    }
+    return writeLEDs(buffer, 5);
+  }
+
+  uint16_t ons[PCA9685_NUM_CHANNELS];
+  uint16_t offs[PCA9685_NUM_CHANNELS];
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    ons[num] = on;
+    offs[num] = off;
+  }
+  return writeRuns(mask, ons, offs);
+}
+
+/*!
+ *  @brief  Sets the same PWM output on any set of pins across a chain of
+ * PCA9685s, see setPWMMask(). Chips attached to an Adafruit_PWMBus queue
+ * their writes for one transfer
+ *  @param  chips Array of 'count' drivers
+ *  @param  count Number of chips in the chain
+ *  @param  masks Array of 'count' pin masks, one per chip, 0 skips a chip
+ *  @param  on At what point in the 4096-part cycle to turn the outputs ON
+ *  @param  off At what point in the 4096-part cycle to turn the outputs OFF
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::setPWMMask(Adafruit_PWMServoDriver *const *chips,
+                                         uint8_t count, const uint16_t *masks,
+                                         uint16_t on, uint16_t off) {
+  bool success = true;
+  for (uint8_t i = 0; i < count; i++) {
+    if (masks[i])
+      success &= chips[i]->setPWMMask(masks[i], on, off);
+  }
+  return success;
+}
+
+/*!
+ *  @brief  Converts a setPin() style value into ON/OFF ticks, properly
+ * handling a zero value as completely off and 4095 as completely on
+ *  @param  val The number of ticks out of 4096 to be active, clamped to 4095
+ *  @param  invert If true, inverts the output
+ *  @param  on Receives the ON tick value
+ *  @param  off Receives the OFF tick value
+ */
+void Adafruit_PWMServoDriver::pinToPWM(uint16_t val, bool invert, uint16_t *on,
+                                       uint16_t *off) {
   // Clamp value between 0 and 4095 inclusive.
   val = min(val, (uint16_t)4095);
 
-  bool success = false;
-
   if (invert) {
     if (val == 0) {
       // Special value for signal fully on.
-      success = setPWM(num, 4096, 0);
+      *on = 4096;
+      *off = 0;
     } else if (val == 4095) {
       // Special value for signal fully off.
-      success = setPWM(num, 0, 4096);
+      *on = 0;
+      *off = 4096;
     } else {
-      success = setPWM(num, 0, 4095 - val);
+      *on = 0;
+      *off = 4095 - val;
     }
   } else {
     if (val == 4095) {
       // Special value for signal fully on.
-      success = setPWM(num, 4096, 0);
+      *on = 4096;
+      *off = 0;
     } else if (val == 0) {
       // Special value for signal fully off.
-      success = setPWM(num, 0, 4096);
+      *on = 0;
+      *off = 4096;
     } else {
-      success = setPWM(num, 0, val);
+      *on = 0;
+      *off = val;
     }
   }
+}
 
-  return success;
+/*!
+ *  @brief  Sets several pins to the same duty cycle, each one shifted by its
+ * own phase, e.g. for multi-phase LED drivers or interleaved loads. Zero and
+ * 4095 are handled as completely off and on like setPin(), other values
+ * wrap around the end of the cycle
+ *  @param  channels Array of 'count' PWM output pins, from 0 to 15
+ *  @param  count Number of pins in the group
+ *  @param  duty The number of ticks out of 4096 to be active, from 0 to 4095
+ *  @param  phaseDegrees Array of 'count' phase shifts in degrees
+ *  @param  invert If true, inverts the outputs, defaults to 'false'
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::setPhasedGroup(const uint8_t *channels,
+                                             uint8_t count, uint16_t duty,
+                                             const uint16_t *phaseDegrees,
+                                             bool invert) {
+  PCA9685_TRACE_ENTRY();
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  uint16_t mask = 0;
+
+  uint16_t pin_on, pin_off;
+  pinToPWM(duty, invert, &pin_on, &pin_off);
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t num = channels[i];
+    if (num >= PCA9685_NUM_CHANNELS)
+      return false;
+    mask |= 1U << num;
+    if ((pin_on | pin_off) & 4096) {
+      // Fully on or off, there is no edge to move
+      on[num] = pin_on;
+      off[num] = pin_off;
+    } else {
+      uint16_t phase =
+          (((uint32_t)(phaseDegrees[i] % 360) << 12) + 180) / 360 & 0xFFF;
+      on[num] = phase;
+      off[num] = (phase + pin_off) & 0xFFF;
+    }
+  }
+  writing(mask);
+  return writeRuns(mask, on, off);
 }
 
 /*!
@@ -296,47 +534,132 @@ bool Adafruit_PWMServoDriver::setPin(uint8_t num, uint16_t val, bool invert) {
  */
 bool Adafruit_PWMServoDriver::writeMicroseconds(uint8_t num,
                                                 uint16_t Microseconds) {
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print("Setting PWM Via Microseconds on output");
-  Serial.print(num);
-  Serial.print(": ");
-  Serial.print(Microseconds);
-  Serial.println("->");
-#endif
+  PCA9685_TRACE_ENTRY();
+  uint16_t pulse = trimmedTicks(num, Microseconds);
+  PCA9685_LOG(PWM_LOG_MICROS, num, Microseconds, pulse);
 
-  double pulse = Microseconds;
-  double pulselength;
-  pulselength = 1000000; // 1,000,000 us per second
+  return setPWM(num, 0, pulse);
+}
 
-  // Read prescale
-  uint16_t prescale = readPrescale();
+/*!
+ *  @brief  Sets the PWM output of a run of consecutive PCA9685 pins based on
+ * the input microseconds, in as few I2C writes as possible
+ *  @param  first The first PWM output pin of the run, from 0 to 15
+ *  @param  count Number of consecutive pins to write
+ *  @param  Microseconds Array of 'count' pulse lengths in microseconds
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::writeMicrosecondsBatch(
+    uint8_t first, uint8_t count, const uint16_t *Microseconds) {
+  PCA9685_TRACE_ENTRY();
+  if (first + count > PCA9685_NUM_CHANNELS)
+    return false;
 
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print(prescale);
-  Serial.println(" PCA9685 chip prescale");
-#endif
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  for (uint8_t i = 0; i < count; i++) {
+    on[i] = 0;
+    off[i] = trimmedTicks(first + i, Microseconds[i]);
+  }
+  return setPWMBurst(first, count, on, off);
+}
 
-  // Calculate the pulse for PWM based on Equation 1 from the datasheet section
-  // 7.3.5
-  prescale += 1;
-  pulselength *= prescale;
-  pulselength /= _oscillator_freq;
+/*!
+ *  @brief  Sets the PWM output of any set of PCA9685 pins based on the input
+ * microseconds, one I2C write per run of consecutive pins
+ *  @param  mask Pins to write, one bit per pin, bit 0 is pin 0
+ *  @param  Microseconds Array of pulse lengths in microseconds, one for each
+ * bit set in 'mask', lowest pin first
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::writeMicrosecondsMask(
+    uint16_t mask, const uint16_t *Microseconds) {
+  PCA9685_TRACE_ENTRY();
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (mask & (1U << num)) {
+      on[num] = 0;
+      off[num] = trimmedTicks(num, *Microseconds++);
+    }
+  }
+  writing(mask);
+  return writeRuns(mask, on, off);
+}
 
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print(pulselength);
-  Serial.println(" us per bit");
-#endif
+/*!
+ *  @brief  Converts a pulse length into PWM ticks at the current prescale and
+ * oscillator frequency (datasheet section 7.3.5, equation 1). The conversion
+ * factor is cached, so the prescale is only read from the chip after it may
+ * have changed
+ *  @param  Microseconds Pulse length in microseconds
+ *  @return OFF tick value, clamped to 4095
+ */
+uint16_t Adafruit_PWMServoDriver::microsecondsToTicks(uint16_t Microseconds) {
+  uint32_t factor = microsecondsFactor();
+  // Split the 16.16 multiply so it cannot overflow 32 bits
+  uint32_t ticks = Microseconds * (factor >> 16) +
+                   ((Microseconds * (factor & 0xFFFF)) >> 16);
+  return min(ticks, (uint32_t)4095);
+}
 
-  pulse /= pulselength;
+#ifndef PCA9685_NO_BATCH
+/*!
+ *  @brief  Starts collecting channel writes: until the returned guard is
+ * committed or goes out of scope, setPWM(), setPin(), writeMicroseconds()
+ * and the burst writes only record their values, which are then sent in one
+ * burst per run of changed channels. Use as
+ * 'auto batch = pwm.beginBatch();'. getPWM() still reads the chip
+ *  @return the batch guard, inactive if a batch is already open
+ */
+Adafruit_PWMBatch Adafruit_PWMServoDriver::beginBatch() {
+  return Adafruit_PWMBatch(_batch ? NULL : this);
+}
+#endif
 
-#ifdef ENABLE_DEBUG_OUTPUT
-  Serial.print(pulse);
-  Serial.println(" pulse for PWM");
+#ifndef PCA9685_NO_TIMING
+/*!
+ *  @brief  Predicts when the last value written to a pin appears at the
+ * output, see Adafruit_PWMTiming
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @return time in microseconds on the micros() clock, 0 without an
+ * attached Adafruit_PWMTiming or before the first write
+ */
+uint32_t Adafruit_PWMServoDriver::predictOutputTime(uint8_t num) {
+  return _timing ? _timing->predictOutputTime(num) : 0;
+}
 #endif
 
-  return setPWM(num, 0, pulse);
+#ifndef PCA9685_NO_TRIMS
+/*!
+ *  @brief  Attaches per-channel pulse calibration, applied by all the
+ * writeMicroseconds functions. The trims are folded into the cached
+ * conversion factor, so they add no work per pulse
+ *  @param  trims Array of 16 trims with offset and gain filled in, must stay
+ * valid while attached. NULL removes the calibration
+ */
+void Adafruit_PWMServoDriver::setTrims(pwm_trim_t *trims) {
+  _trims = trims;
+  updateTrims();
 }
 
+/*!
+ *  @brief  Changes the calibration of one channel, setTrims() must have been
+ * called first
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  offset Microseconds added to every pulse
+ *  @param  gain Pulse length scale, PWM_TRIM_UNITY is 1.0
+ */
+void Adafruit_PWMServoDriver::setTrim(uint8_t num, int16_t offset,
+                                      uint16_t gain) {
+  if (!_trims || num >= PCA9685_NUM_CHANNELS)
+    return;
+  _trims[num].offset = offset;
+  _trims[num].gain = gain;
+  updateTrims();
+}
+#endif
+
 /*!
  *  @brief  Setups the I2C interface and hardware, does not write to device
  *  @return true if successful, otherwise false
@@ -356,6 +679,21 @@ bool Adafruit_PWMServoDriver::beginBarebones() {
 }
 
 bool Adafruit_PWMServoDriver::setAllOff() {
+    PCA9685_TRACE_ENTRY();
+    // Overrides every channel, so pending batch writes are obsolete
+#ifndef PCA9685_NO_BATCH
+    if (_batch)
+        _batch->_mask = 0;
+#endif
+#ifndef PCA9685_NO_COMBINER
+    if (_combiner)
+        _combiner->discard();
+#endif
+#ifndef PCA9685_NO_DRIFT
+    if (_drift)
+        _drift->release(0xFFFF);
+#endif
+
     // Values for signal fully off.
     uint16_t on  = 0;
     uint16_t off = 4096;
@@ -367,10 +705,10 @@ bool Adafruit_PWMServoDriver::setAllOff() {
     buffer[3] = off;
     buffer[4] = off >> 8;
 
-    return i2c_dev->write(buffer, 5);
+    return writeLEDs(buffer, 5);
 }
 
-bool Adafruit_PWMServoDriver::isFreqSet(float freq) {
+bool Adafruit_PWMServoDriver::isFreqSet(pca9685_freq_t freq) {
     // Checks if the desired frequency is already set
     // Works by seeing if the prescale would actually be changed by the new frequency, hence
     // providing a way to avoid unnecessary changes, useful to avoid glitches.
@@ -398,22 +736,212 @@ uint32_t Adafruit_PWMServoDriver::getOscillatorFrequency(void) {
  */
 void Adafruit_PWMServoDriver::setOscillatorFrequency(uint32_t freq) {
   _oscillator_freq = freq;
+  _us_factor = 0;
 }
 
 /******************* Low level I2C interface */
 uint8_t Adafruit_PWMServoDriver::read8(uint8_t addr) {
+  PCA9685_PROFILE(PWM_PROFILE_BUS_READ);
   uint8_t buffer[1] = {addr};
   i2c_dev->write_then_read(buffer, 1, buffer, 1);
   return buffer[0];
 }
 
-void Adafruit_PWMServoDriver::write8(uint8_t addr, uint8_t d) {
+bool Adafruit_PWMServoDriver::write8(uint8_t addr, uint8_t d) {
+#ifndef PCA9685_NO_COMBINER
+  // Channel writes held before this register write reach the chip first
+  if (_combiner)
+    _combiner->flush();
+#endif
+  PCA9685_PROFILE(PWM_PROFILE_BUS_WRITE);
   uint8_t buffer[2] = {addr, d};
-  i2c_dev->write(buffer, 2);
+#ifndef PCA9685_NO_MIRROR
+  if (_mirror)
+    _mirror->sent(_i2caddr, buffer, 2);
+#endif
+  return i2c_dev->write(buffer, 2);
+}
+
+/*!
+ *  @brief  Reports a finished operation to the attached completion queue
+ *  @param  kind One of pwm_completion_kind_t
+ *  @param  value Result of the operation
+ *  @param  success Whether all i2c transfers succeeded
+ */
+void Adafruit_PWMServoDriver::complete(uint8_t kind, uint16_t value,
+                                       bool success) {
+#ifndef PCA9685_NO_COMPLETIONS
+  if (_completions)
+    _completions->post(this, NULL, kind, value, success);
+#else
+  (void)kind;
+  (void)value;
+  (void)success;
+#endif
+}
+
+/*!
+ *  @brief  Tells the attached oscillator tracker that channels are being
+ * written, so it stops rewriting those not written with a pulse length
+ *  @param  mask One bit per channel being written
+ */
+void Adafruit_PWMServoDriver::writing(uint16_t mask) {
+#ifndef PCA9685_NO_DRIFT
+  if (_drift)
+    _drift->written(mask);
+#else
+  (void)mask;
+#endif
+}
+
+/*!
+ *  @brief  Writes a block of LED registers, or queues it on the attached bus
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes
+ *  @return success of the i2c write, true once queued
+ */
+bool Adafruit_PWMServoDriver::writeLEDs(const uint8_t *buffer, uint8_t len) {
+#ifndef PCA9685_NO_TIMING
+  if (_timing) {
+#ifndef PCA9685_NO_BUS
+    if (_bus)
+      _timing->queued(buffer, len); // stamped by the bus when sent
+    else
+#endif
+      // Address byte and payload
+      _timing->sent(buffer, len, micros(), 1 + len);
+  }
+#endif
+#ifndef PCA9685_NO_MIRROR
+  if (_mirror)
+    _mirror->sent(_i2caddr, buffer, len);
+#endif
+#ifndef PCA9685_NO_BUS
+  if (_bus)
+    return _bus->queue(this, buffer, len);
+#endif
+#ifdef PCA9685_ENABLE_TRACING
+  pwm_trace_t trace;
+  trace.encoded = trace.enqueued = trace.started = micros();
+  trace.entry = _trace_entry ? _trace_entry : trace.encoded;
+#endif
+  bool success;
+  {
+    PCA9685_PROFILE(PWM_PROFILE_BUS_WRITE);
+    success = i2c_dev->write(buffer, len);
+  }
+#ifdef PCA9685_ENABLE_TRACING
+  trace.done = micros();
+  if (_trace)
+    _trace->record(&trace);
+#endif
+  return success;
+}
+
+/*!
+ *  @brief  Writes the pins selected by a mask, one burst per run of
+ * consecutive pins, without telling the oscillator tracker
+ *  @param  mask One bit per pin, bit 0 is pin 0
+ *  @param  on Array of 16 ON tick values, indexed by pin
+ *  @param  off Array of 16 OFF tick values, indexed by pin
+ *  @return success of all i2c writes
+ */
+bool Adafruit_PWMServoDriver::writeRuns(uint16_t mask, const uint16_t *on,
+                                        const uint16_t *off) {
+  bool success = true;
+  uint8_t num = 0;
+  while (mask >> num) {
+    if (!(mask & (1U << num))) {
+      num++;
+      continue;
+    }
+    uint8_t first = num;
+    while (num < PCA9685_NUM_CHANNELS && (mask & (1U << num)))
+      num++;
+    success &= writeBurst(first, num - first, &on[first], &off[first]);
+  }
+  return success;
 }
 
-uint8_t Adafruit_PWMServoDriver::calcPrescale(float freq) const {
+/*!
+ *  @brief  Gets the cached PWM ticks per microsecond, reading the prescale
+ * from the chip if it is not known
+ *  @return ticks per microsecond, 16.16 fixed point
+ */
+uint32_t Adafruit_PWMServoDriver::microsecondsFactor() {
+  if (!_us_factor) {
+    uint16_t prescale = readPrescale();
+
+    // ticks per second, then * 65536 / 1000000 == * 1024 / 15625
+    uint32_t rate = _oscillator_freq / (prescale + 1);
+    _us_factor = (rate / 15625) * 1024 + (rate % 15625) * 1024 / 15625;
+    PCA9685_LOG(PWM_LOG_PRESCALE, prescale, _us_factor, _us_factor >> 16);
+#ifndef PCA9685_NO_TRIMS
+    updateTrims();
+#endif
+  }
+  return _us_factor;
+}
+
+#ifndef PCA9685_NO_TRIMS
+/*!
+ *  @brief  Recomputes the trimmed conversion factor of every channel, if the
+ * base factor is known. Otherwise this happens when it gets computed
+ */
+void Adafruit_PWMServoDriver::updateTrims() {
+  if (!_trims || !_us_factor)
+    return;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    pwm_trim_t *t = &_trims[num];
+    t->factor = (_us_factor >> 15) * t->gain +
+                (((_us_factor & 0x7FFF) * t->gain) >> 15);
+    // The offset times a high frequency factor above unity gain overflows
+    // 32 bits; the clamp keeps the sum in trimmedTicks() in range
+    int64_t ticks = ((int64_t)t->offset * t->factor) >> 12;
+    t->ticks = constrain(ticks, -(1LL << 30), 1LL << 30);
+  }
+}
+#endif
+
+/*!
+ *  @brief  Converts a pulse length into PWM ticks for one channel, with its
+ * calibration applied
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @param  Microseconds Pulse length in microseconds
+ *  @return OFF tick value, clamped to 0..4095
+ */
+uint16_t Adafruit_PWMServoDriver::trimmedTicks(uint8_t num,
+                                               uint16_t Microseconds) {
+  PCA9685_PROFILE(PWM_PROFILE_ENCODE);
+#ifndef PCA9685_NO_DRIFT
+  if (_drift && num < PCA9685_NUM_CHANNELS)
+    _drift->track(num, Microseconds);
+#endif
+#ifdef PCA9685_NO_TRIMS
+  (void)num;
+  return microsecondsToTicks(Microseconds);
+#else
+  if (!_trims || num >= PCA9685_NUM_CHANNELS)
+    return microsecondsToTicks(Microseconds);
+  microsecondsFactor(); // brings the trims up to date
+
+  // In 1/16 ticks so the offset keeps sub-tick precision
+  const pwm_trim_t *t = &_trims[num];
+  int32_t ticks = ((Microseconds * (t->factor >> 16)) << 4) +
+                  ((Microseconds * (t->factor & 0xFFFF)) >> 12) + t->ticks;
+  return constrain(ticks >> 4, (int32_t)0, (int32_t)4095);
+#endif
+}
+
+uint8_t Adafruit_PWMServoDriver::calcPrescale(pca9685_freq_t freq) const {
+#ifdef PCA9685_NO_FLOAT
+    // Same rounding as below: floor(osc / (freq * 4096) + 0.5) - 1
+    uint32_t ticks_per_sec = (uint32_t)max(freq, (uint16_t)1) * 4096;
+    int32_t prescaleval =
+        (int32_t)((_oscillator_freq + ticks_per_sec / 2) / ticks_per_sec) - 1;
+#else
     float prescaleval = ((_oscillator_freq / (freq * 4096.0)) + 0.5) - 1;
+#endif
 
     if (prescaleval < PCA9685_PRESCALE_MIN) prescaleval = PCA9685_PRESCALE_MIN;
     if (prescaleval > PCA9685_PRESCALE_MAX) prescaleval = PCA9685_PRESCALE_MAX;
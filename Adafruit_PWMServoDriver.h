@@ -26,6 +26,8 @@
 #include <Adafruit_I2CDevice.h>
 #include <Arduino.h>
 
+#include "Adafruit_PWMServoDriver_config.h"
+
 // REGISTER ADDRESSES
 #define PCA9685_MODE1 0x00      /**< Mode Register 1 */
 #define PCA9685_MODE2 0x01      /**< Mode Register 2 */
@@ -68,6 +70,33 @@
 #define PCA9685_PRESCALE_MIN 3   /**< minimum prescale value */
 #define PCA9685_PRESCALE_MAX 255 /**< maximum prescale value */
 
+#define PCA9685_NUM_CHANNELS 16 /**< number of PWM output channels */
+
+#define PWM_TRIM_UNITY 32768 /**< Trim gain of 1.0 */
+
+/*!
+ *  @brief  Per-channel pulse calibration used by the writeMicroseconds
+ * functions
+ */
+typedef struct {
+  int16_t offset;  ///< Microseconds added to every pulse, before the gain
+  uint16_t gain;   ///< Pulse length scale, PWM_TRIM_UNITY is 1.0
+  uint32_t factor; ///< Used internally, trimmed ticks per microsecond
+  int32_t ticks;   ///< Used internally, offset in 1/16 ticks
+} pwm_trim_t;
+
+#ifndef PCA9685_NO_BATCH
+#include "Adafruit_PWMBatch.h"
+#endif
+
+class Adafruit_PWMBus;
+class Adafruit_PWMCombiner;
+class Adafruit_PWMCompletions;
+class Adafruit_PWMDrift;
+class Adafruit_PWMMirror;
+class Adafruit_PWMTiming;
+class Adafruit_PWMTrace;
+
 /*!
  *  @brief  Class that stores state and functions for interacting with PCA9685
  * PWM chip
@@ -83,32 +112,106 @@ public:
   void sleep();
   void wakeup();
   void setExtClk(uint8_t prescale);
-  void setPWMFreq(float freq);
+  void setPWMFreq(pca9685_freq_t freq);
   void setOutputMode(bool totempole);
   uint16_t getPWM(uint8_t num, bool off = false);
   bool setPWM(uint8_t num, uint16_t on, uint16_t off);
   bool setPin(uint8_t num, uint16_t val, bool invert = false);
+  bool setPWMBurst(uint8_t first, uint8_t count, const uint16_t *on,
+                   const uint16_t *off);
+  bool setPWMMask(uint16_t mask, uint16_t on, uint16_t off);
+  static bool setPWMMask(Adafruit_PWMServoDriver *const *chips, uint8_t count,
+                         const uint16_t *masks, uint16_t on, uint16_t off);
+  static void pinToPWM(uint16_t val, bool invert, uint16_t *on,
+                       uint16_t *off);
+  bool setPhasedGroup(const uint8_t *channels, uint8_t count, uint16_t duty,
+                      const uint16_t *phaseDegrees, bool invert = false);
   uint8_t readPrescale(void);
   bool writeMicroseconds(uint8_t num, uint16_t Microseconds);
+  bool writeMicrosecondsBatch(uint8_t first, uint8_t count,
+                              const uint16_t *Microseconds);
+  bool writeMicrosecondsMask(uint16_t mask, const uint16_t *Microseconds);
+  uint16_t microsecondsToTicks(uint16_t Microseconds);
+#ifndef PCA9685_NO_BATCH
+  Adafruit_PWMBatch beginBatch();
+#endif
+#ifndef PCA9685_NO_TIMING
+  uint32_t predictOutputTime(uint8_t num);
+#endif
+#ifndef PCA9685_NO_TRIMS
+  void setTrims(pwm_trim_t *trims);
+  void setTrim(uint8_t num, int16_t offset, uint16_t gain = PWM_TRIM_UNITY);
+#endif
 
   // Added to API
   bool beginBarebones();
   bool setAllOff();
-  bool isFreqSet(float freq);
+  bool isFreqSet(pca9685_freq_t freq);
 
   void setOscillatorFrequency(uint32_t freq);
   uint32_t getOscillatorFrequency(void);
 
 private:
+  friend class Adafruit_PWMBatch;
+  friend class Adafruit_PWMBus;
+  friend class Adafruit_PWMCombiner;
+  friend class Adafruit_PWMCompletions;
+  friend class Adafruit_PWMDrift;
+  friend class Adafruit_PWMMirror;
+  friend class Adafruit_PWMShow;
+  friend class Adafruit_PWMTiming;
+  friend class Adafruit_PWMTrace;
+  friend class Adafruit_PWMTraceEntry;
+
   uint8_t _i2caddr;
   TwoWire *_i2c;
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
 
   uint32_t _oscillator_freq;
+  uint32_t _us_factor = 0; ///< Ticks per microsecond, 16.16, 0 when unknown
+#ifndef PCA9685_NO_TRIMS
+  pwm_trim_t *_trims = NULL; ///< Optional per-channel calibration
+#endif
+#ifndef PCA9685_NO_BATCH
+  Adafruit_PWMBatch *_batch = NULL; ///< Guard collecting writes, if any
+#endif
+#ifndef PCA9685_NO_BUS
+  Adafruit_PWMBus *_bus = NULL; ///< Bus queueing LED writes, if any
+#endif
+#ifndef PCA9685_NO_COMBINER
+  Adafruit_PWMCombiner *_combiner = NULL; ///< Write-combining window, if any
+#endif
+#ifndef PCA9685_NO_COMPLETIONS
+  Adafruit_PWMCompletions *_completions = NULL; ///< Completion queue, if any
+#endif
+#ifndef PCA9685_NO_TIMING
+  Adafruit_PWMTiming *_timing = NULL; ///< Output latency model, if any
+#endif
+#ifndef PCA9685_NO_DRIFT
+  Adafruit_PWMDrift *_drift = NULL; ///< Oscillator tracker, if any
+#endif
+#ifndef PCA9685_NO_MIRROR
+  Adafruit_PWMMirror *_mirror = NULL; ///< Standby register stream, if any
+#endif
+#ifdef PCA9685_ENABLE_TRACING
+  Adafruit_PWMTrace *_trace = NULL; ///< Latency histograms, if any
+  uint32_t _trace_entry = 0;        ///< Entry time of the current call
+#endif
   uint8_t read8(uint8_t addr);
-  void write8(uint8_t addr, uint8_t d);
+  bool write8(uint8_t addr, uint8_t d);
+  void complete(uint8_t kind, uint16_t value, bool success);
+  void writing(uint16_t mask);
 
-  uint8_t calcPrescale(float freq) const;
+  uint8_t calcPrescale(pca9685_freq_t freq) const;
+  bool writeLEDs(const uint8_t *buffer, uint8_t len);
+  bool writeBurst(uint8_t first, uint8_t count, const uint16_t *on,
+                  const uint16_t *off);
+  bool writeRuns(uint16_t mask, const uint16_t *on, const uint16_t *off);
+  uint32_t microsecondsFactor();
+#ifndef PCA9685_NO_TRIMS
+  void updateTrims();
+#endif
+  uint16_t trimmedTicks(uint8_t num, uint16_t Microseconds);
 };
 
 #endif
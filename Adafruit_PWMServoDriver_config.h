@@ -0,0 +1,74 @@
+/*!
+ *  @file Adafruit_PWMServoDriver_config.h
+ *
+ *  Compile time options for the PCA9685 driver. Set them with build flags
+ *  (e.g. -DPCA9685_TINY) or by defining them at the top of this file.
+ *
+ *  PCA9685_TINY      Smallest integer-only driver for ATtiny / ATmega168,
+ *                    enables all of the options below
+ *  PCA9685_NO_FLOAT  setPWMFreq() and isFreqSet() take an integer frequency
+ *                    in Hz and no floating point code is linked
+ *  ENABLE_DEBUG_OUTPUT  Record driver events in the binary debug log, see
+ *                    Adafruit_PWMDebugLog.h
+ *  PCA9685_NO_DEBUG  Never build the debug log calls, even with
+ *                    ENABLE_DEBUG_OUTPUT
+ *  PCA9685_ENABLE_PROFILING  Time the encode, bus and wait phases of the
+ *                    driver, see Adafruit_PWMProfile.h
+ *  PCA9685_ENABLE_TRACING  Record per write latencies from API call to bus
+ *                    STOP, see Adafruit_PWMTrace.h
+ *  PCA9685_NO_TRIMS  Remove per-channel pulse calibration (setTrims())
+ *  PCA9685_NO_DELAY  Wait with delayMicroseconds() instead of delay(), so the
+ *                    driver does not depend on the millisecond timer
+ *  PCA9685_NO_BATCH  Remove beginBatch() and the write collection hooks
+ *  PCA9685_NO_BUS    Remove the hooks queueing LED writes on an
+ *                    Adafruit_PWMBus
+ *  PCA9685_NO_COMPLETIONS  Remove the hooks posting to an
+ *                    Adafruit_PWMCompletions queue
+ *  PCA9685_NO_TIMING Remove predictOutputTime() and the Adafruit_PWMTiming
+ *                    hook
+ *  PCA9685_NO_COMBINER  Remove the Adafruit_PWMCombiner write-combining
+ *                    hooks
+ *  PCA9685_NO_DRIFT  Remove the Adafruit_PWMDrift oscillator tracking hooks
+ *  PCA9685_NO_MIRROR Remove the Adafruit_PWMMirror register streaming hooks
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMServoDriver_config_H
+#define _ADAFRUIT_PWMServoDriver_config_H
+
+#ifdef PCA9685_TINY
+#define PCA9685_NO_FLOAT
+#define PCA9685_NO_DEBUG
+#define PCA9685_NO_TRIMS
+#define PCA9685_NO_DELAY
+#define PCA9685_NO_BATCH
+#define PCA9685_NO_BUS
+#define PCA9685_NO_COMPLETIONS
+#define PCA9685_NO_TIMING
+#define PCA9685_NO_COMBINER
+#define PCA9685_NO_DRIFT
+#define PCA9685_NO_MIRROR
+#endif
+
+//#define ENABLE_DEBUG_OUTPUT
+
+#ifdef PCA9685_NO_DEBUG
+#undef ENABLE_DEBUG_OUTPUT
+#endif
+
+#ifdef PCA9685_NO_FLOAT
+typedef uint16_t pca9685_freq_t; ///< PWM frequency in Hz
+#else
+typedef float pca9685_freq_t; ///< PWM frequency in Hz
+#endif
+
+#ifdef PCA9685_NO_DELAY
+/** Busy wait without the millisecond timer */
+#define PCA9685_DELAY(ms)                                                      \
+  for (uint8_t _ms = (ms); _ms; _ms--)                                         \
+  delayMicroseconds(1000)
+#else
+#define PCA9685_DELAY(ms) delay(ms) /**< Wait for the chip */
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+/*!
+ *  @file Adafruit_PWMShow.cpp
+ *
+ *  Format (all numbers little endian): 'P', 'S', version, flags, then one
+ *  record per frame: the delay after the previous frame in microseconds
+ *  (16 bit), the number of writes (8 bit) and each write as chip address,
+ *  first register, payload length and payload. Frame times are derived
+ *  from the previous due time rather than from when a frame was played,
+ *  so a late poll() does not push back the rest of the show.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMShow.h"
+#include "Adafruit_PWMBus.h"
+
+/*!
+ *  @brief  Instantiates a player for a chain of chips
+ *  @param  chips Array of 'count' drivers, begun and set to the show's
+ * frequency, writes are routed by I2C address
+ *  @param  count Number of chips
+ */
+Adafruit_PWMShow::Adafruit_PWMShow(Adafruit_PWMServoDriver *const *chips,
+                                   uint8_t count)
+    : _chips(chips), _count(count), _show(NULL), _len(0), _progmem(false),
+      _playing(false), _loop(false), _pos(0), _due(0), _frame(0),
+      _errors(0) {}
+
+/*!
+ *  @brief  Loads a compiled show
+ *  @param  show The compiled show, must stay valid while it is played
+ *  @param  len Size of the show in bytes
+ *  @param  progmem If true, the show lives in PROGMEM (the first 64 KB on
+ * AVR)
+ *  @return false if the header is not a show of this version
+ */
+bool Adafruit_PWMShow::begin(const uint8_t *show, uint32_t len,
+                             bool progmem) {
+  stop();
+  _show = show;
+  _len = len;
+  _progmem = progmem;
+  if (len < PWM_SHOW_HEADER || byteAt(0) != 'P' || byteAt(1) != 'S' ||
+      byteAt(2) != PWM_SHOW_VERSION) {
+    _len = 0;
+    return false;
+  }
+  return true;
+}
+
+/*!
+ *  @brief  Starts the show from the beginning
+ *  @param  loop If true, start over at the end instead of stopping
+ */
+void Adafruit_PWMShow::play(bool loop) {
+  _loop = loop;
+  _frame = 0;
+  _pos = PWM_SHOW_HEADER;
+  _playing = _len >= PWM_SHOW_HEADER + 3;
+  if (_playing)
+    _due = micros() + (byteAt(_pos) | (uint16_t)byteAt(_pos + 1) << 8);
+}
+
+/*!
+ *  @brief  Stops the show, the outputs keep their last values
+ */
+void Adafruit_PWMShow::stop() { _playing = false; }
+
+/*!
+ *  @brief  Plays the frames that are due, up to the end of the show. Call
+ * as often as possible, e.g. from loop()
+ *  @return success of the i2c writes, true if no frame was due
+ */
+bool Adafruit_PWMShow::poll() {
+  bool success = true;
+  while (_playing && (int32_t)(micros() - _due) >= 0) {
+    success &= playFrame();
+    // At most one pass per call, a looped show without delays would
+    // otherwise never return
+    if (_pos == PWM_SHOW_HEADER)
+      break;
+  }
+  return success;
+}
+
+/*!
+ *  @brief  Reads a byte of the show
+ *  @param  pos Offset in the show
+ *  @return the byte
+ */
+uint8_t Adafruit_PWMShow::byteAt(uint32_t pos) const {
+  if (_progmem)
+    return pgm_read_byte(&_show[pos]);
+  return _show[pos];
+}
+
+/*!
+ *  @brief  Finds the driver of a chip
+ *  @param  addr 7 bit I2C address
+ *  @return the driver, NULL if not in the chain
+ */
+Adafruit_PWMServoDriver *Adafruit_PWMShow::chip(uint8_t addr) const {
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_chips[i]->_i2caddr == addr)
+      return _chips[i];
+  }
+  return NULL;
+}
+
+/*!
+ *  @brief  Sends the writes of the frame at the play position and moves on
+ * to the next frame
+ *  @return success of the i2c writes
+ */
+bool Adafruit_PWMShow::playFrame() {
+  bool success = true;
+  uint32_t pos = _pos + 2;
+  uint8_t writes = byteAt(pos++);
+  uint8_t buffer[1 + PWM_SHOW_MAX_PAYLOAD];
+  while (writes--) {
+    if (pos + 3 > _len || pos + 3 + byteAt(pos + 2) > _len) {
+      // Truncated show
+      _errors++;
+      _playing = false;
+      return false;
+    }
+    Adafruit_PWMServoDriver *pwm = chip(byteAt(pos));
+    uint8_t reg = byteAt(pos + 1);
+    uint8_t len = byteAt(pos + 2);
+    pos += 3;
+    // LED registers only, configuration stays with the application, and
+    // the whole write must fit the bus buffer
+    bool leds = reg == PCA9685_ALLLED_ON_L
+                    ? len <= 4
+                    : reg >= PCA9685_LED0_ON_L &&
+                          reg + len <=
+                              PCA9685_LED0_ON_L + 4 * PCA9685_NUM_CHANNELS;
+    if (!pwm || !len || len > PWM_SHOW_MAX_PAYLOAD || !leds ||
+        (size_t)len + 1 > pwm->i2c_dev->maxBufferSize()) {
+      _errors++;
+      pos += len;
+      continue;
+    }
+    buffer[0] = reg;
+    for (uint8_t i = 0; i < len; i++)
+      buffer[1 + i] = byteAt(pos++);
+    uint16_t channels = 0xFFFF;
+    if (reg != PCA9685_ALLLED_ON_L) {
+      uint8_t first = (reg - PCA9685_LED0_ON_L) / 4;
+      uint8_t last = (reg - PCA9685_LED0_ON_L + len - 1) / 4;
+      channels = (uint16_t)((1UL << (last + 1)) - (1UL << first));
+    }
+    pwm->writing(channels);
+    success &= pwm->writeLEDs(buffer, 1 + len);
+  }
+
+#ifndef PCA9685_NO_BUS
+  // Chips on a bus queue send the frame in one transfer
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_chips[i]->_bus && _chips[i]->_bus->pending())
+      success &= _chips[i]->_bus->flush();
+  }
+#endif
+  _frame++;
+
+  _pos = pos;
+  if (_pos + 3 > _len) {
+    if (!_loop) {
+      _playing = false;
+      return success;
+    }
+    _pos = PWM_SHOW_HEADER;
+  }
+  _due += byteAt(_pos) | (uint16_t)byteAt(_pos + 1) << 8;
+  return success;
+}
@@ -0,0 +1,71 @@
+/*!
+ *  @file Adafruit_PWMShow.h
+ *
+ *  Player for shows compiled ahead of time by extras/show_compiler. The
+ *  compiled show is a stream of frames, each a delay followed by ready
+ *  made LED register writes, so playing it costs nothing but timing and
+ *  bus writes: no interpolation, conversion, diffing or planning on the
+ *  microcontroller.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMShow_H
+#define _ADAFRUIT_PWMShow_H
+
+#include "Adafruit_PWMServoDriver.h"
+
+#define PWM_SHOW_VERSION 1      /**< Compiled show format version */
+#define PWM_SHOW_HEADER 4       /**< 'P', 'S', version, flags */
+#define PWM_SHOW_MAX_PAYLOAD 64 /**< Most register bytes in one write */
+
+/*!
+ *  @brief  Class that replays a compiled show on a chain of PCA9685s
+ */
+class Adafruit_PWMShow {
+public:
+  Adafruit_PWMShow(Adafruit_PWMServoDriver *const *chips, uint8_t count);
+
+  bool begin(const uint8_t *show, uint32_t len, bool progmem = false);
+  void play(bool loop = false);
+  void stop();
+  bool poll();
+
+  /*!
+   *  @brief  Whether the show is running
+   *  @return true from play() until the end of the show or stop()
+   */
+  bool playing() const { return _playing; }
+
+  /*!
+   *  @brief  Frames played since play()
+   *  @return frame count
+   */
+  uint32_t frame() const { return _frame; }
+
+  /*!
+   *  @brief  Writes skipped because they were malformed, ran past the LED
+   * registers, did not fit the bus buffer or were addressed to a chip not in
+   * the chain
+   *  @return skipped write count
+   */
+  uint32_t errors() const { return _errors; }
+
+private:
+  uint8_t byteAt(uint32_t pos) const;
+  Adafruit_PWMServoDriver *chip(uint8_t addr) const;
+  bool playFrame();
+
+  Adafruit_PWMServoDriver *const *_chips;
+  uint8_t _count;
+  const uint8_t *_show;
+  uint32_t _len;
+  bool _progmem;
+  bool _playing;
+  bool _loop;
+  uint32_t _pos;  // next frame in the show
+  uint32_t _due;  // micros() when the next frame is due
+  uint32_t _frame;
+  uint32_t _errors;
+};
+
+#endif
@@ -0,0 +1,148 @@
+/*!
+ *  @file Adafruit_PWMSpline.cpp
+ *
+ *  Keyframe tracks interpolated with Catmull-Rom or cubic Bezier segments.
+ *  Each segment is converted once into a cubic polynomial and then sampled
+ *  by forward differencing, so producing a sample costs three 64-bit adds
+ *  instead of evaluating the cubic. The truncation of the third difference
+ *  adds up to about n^3 / 6 units of 2^-32 after n samples, so with 32
+ *  fractional bits segments are limited to PWM_SPLINE_MAX_SAMPLES samples
+ *  (1/20 tick of error at most), and every segment restarts from its exact
+ *  keyframe value.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMSpline.h"
+
+#define FIX_ONE ((int64_t)1 << 32) // 1.0 in 32.32 fixed point
+
+/*!
+ *  @brief  Instantiates a track driving one channel of a frame
+ *  @param  frame The frame that receives the samples
+ *  @param  num One of the PWM output pins, from 0 to 15
+ */
+Adafruit_PWMSplineTrack::Adafruit_PWMSplineTrack(Adafruit_PWMFrame &frame,
+                                                 uint8_t num)
+    : _frame(&frame), _keys(NULL), _num(num), _count(0), _index(0), _type(0),
+      _loop(false), _frame_ms(20), _remaining(0), _end(0), _v(0), _d1(0),
+      _d2(0), _d3(0) {}
+
+/*!
+ *  @brief  Starts playing a keyframe track from its first keyframe
+ *  @param  keys Array of keyframes, must stay valid while playing. The
+ * duration of the first keyframe is ignored
+ *  @param  count Number of keyframes, at least 2 (4 for Bezier tracks)
+ *  @param  frame_ms Time between two calls to step(), in milliseconds.
+ * Segment durations are rounded to whole frames and limited to
+ * PWM_SPLINE_MAX_SAMPLES frames (20 s at 20 ms), split longer moves with
+ * more keyframes
+ *  @param  type How the keyframes are interpolated
+ *  @param  loop If true, restart from the first keyframe at the end
+ */
+void Adafruit_PWMSplineTrack::play(const pwm_keyframe_t *keys, uint8_t count,
+                                   uint16_t frame_ms, pwm_spline_t type,
+                                   bool loop) {
+  if (count < (type == PWM_SPLINE_BEZIER ? 4 : 2) || !frame_ms) {
+    stop();
+    return;
+  }
+  _keys = keys;
+  _count = count;
+  _frame_ms = frame_ms;
+  _type = type;
+  _loop = loop;
+  _index = 0;
+  beginSegment();
+}
+
+/*!
+ *  @brief  Stops the track, the channel keeps its last sample
+ */
+void Adafruit_PWMSplineTrack::stop() {
+  _keys = NULL;
+  _remaining = 0;
+}
+
+/*!
+ *  @brief  Produces the next sample and writes it into the frame. Call once
+ * per output frame, then flush the frame
+ *  @return true while the track is playing
+ */
+bool Adafruit_PWMSplineTrack::step() {
+  if (!_keys)
+    return false;
+
+  _v += _d1;
+  _d1 += _d2;
+  _d2 += _d3;
+
+  int32_t value;
+  if (--_remaining == 0) {
+    value = _end;
+    _index += _type == PWM_SPLINE_BEZIER ? 3 : 1;
+    if (_index + (_type == PWM_SPLINE_BEZIER ? 3 : 1) >= _count) {
+      if (_loop)
+        _index = 0;
+      else
+        _keys = NULL;
+    }
+    if (_keys)
+      beginSegment();
+  } else {
+    value = (int32_t)((_v + FIX_ONE / 2) >> 32);
+    // Catmull-Rom segments may overshoot their keyframes
+    value = constrain(value, 0, 4095);
+  }
+
+  _frame->setPWM(_num, 0, value);
+  return _keys != NULL;
+}
+
+/*!
+ *  @brief  Computes the polynomial of the segment starting at _index and
+ * sets up its forward differences
+ */
+void Adafruit_PWMSplineTrack::beginSegment() {
+  const pwm_keyframe_t *k = &_keys[_index];
+  // Twice the cubic coefficients, so Catmull-Rom's halves stay integers
+  int32_t a, b, c, start;
+  uint16_t duration;
+
+  if (_type == PWM_SPLINE_BEZIER) {
+    int32_t p0 = k[0].value, p1 = k[1].value, p2 = k[2].value,
+            p3 = k[3].value;
+    a = 2 * (-p0 + 3 * p1 - 3 * p2 + p3);
+    b = 2 * (3 * p0 - 6 * p1 + 3 * p2);
+    c = 2 * (-3 * p0 + 3 * p1);
+    start = p0;
+    _end = p3;
+    duration = k[3].duration;
+  } else {
+    int32_t p1 = k[0].value, p2 = k[1].value;
+    int32_t p0 = _index ? k[-1].value : p1;
+    int32_t p3 = _index + 2 < _count ? k[2].value : p2;
+    a = -p0 + 3 * p1 - 3 * p2 + p3;
+    b = 2 * p0 - 5 * p1 + 4 * p2 - p3;
+    c = -p0 + p2;
+    start = p1;
+    _end = p2;
+    duration = k[1].duration;
+  }
+
+  int64_t n = constrain(((uint32_t)duration + _frame_ms / 2) / _frame_ms,
+                        (uint32_t)1, (uint32_t)PWM_SPLINE_MAX_SAMPLES);
+  int64_t n2 = n * n;
+  int64_t n3 = n2 * n;
+  _remaining = n;
+
+  // With step h = 1/n and the doubled coefficients:
+  //   d1 = (a h^3 + b h^2 + c h) / 2
+  //   d2 = 3 a h^3 + b h^2
+  //   d3 = 3 a h^3
+  _v = start * FIX_ONE;
+  _d1 = a * (FIX_ONE / 2) / n3 + b * (FIX_ONE / 2) / n2 +
+        c * (FIX_ONE / 2) / n;
+  _d3 = 3 * a * FIX_ONE / n3;
+  _d2 = _d3 + b * FIX_ONE / n2;
+}
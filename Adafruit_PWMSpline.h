@@ -0,0 +1,73 @@
+/*!
+ *  @file Adafruit_PWMSpline.h
+ *
+ *  Smooth multi-point keyframe tracks for a single PCA9685 channel.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMSpline_H
+#define _ADAFRUIT_PWMSpline_H
+
+#include "Adafruit_PWMFrame.h"
+
+/** Most samples in one segment. Forward differencing error grows with the
+ * cube of the sample count; at this length it stays below 1/20 tick */
+#define PWM_SPLINE_MAX_SAMPLES 1024
+
+/*!
+ *  @brief  One point of a keyframe track
+ */
+typedef struct {
+  uint16_t duration; ///< Milliseconds from the previous keyframe to this one
+  uint16_t value;    ///< Channel OFF tick at this keyframe, from 0 to 4095
+} pwm_keyframe_t;
+
+/*!
+ *  @brief  How the keyframes of a track are interpolated
+ */
+typedef enum {
+  /** Curve passes through every keyframe */
+  PWM_SPLINE_CATMULL_ROM,
+  /** Keyframes are grouped as start, control, control, end, control, ...
+   * Only the duration of the end keyframe of each segment is used */
+  PWM_SPLINE_BEZIER,
+} pwm_spline_t;
+
+/*!
+ *  @brief  Class that plays a cubic keyframe track on one channel of a frame,
+ * one sample per output frame
+ */
+class Adafruit_PWMSplineTrack {
+public:
+  Adafruit_PWMSplineTrack(Adafruit_PWMFrame &frame, uint8_t num);
+
+  void play(const pwm_keyframe_t *keys, uint8_t count, uint16_t frame_ms,
+            pwm_spline_t type = PWM_SPLINE_CATMULL_ROM, bool loop = false);
+  void stop();
+  bool step();
+
+  /*!
+   *  @brief  Checks if the track is still playing
+   *  @return true until the last keyframe has been reached
+   */
+  bool isPlaying() const { return _keys != NULL; }
+
+private:
+  void beginSegment();
+
+  Adafruit_PWMFrame *_frame;
+  const pwm_keyframe_t *_keys;
+  uint8_t _num;
+  uint8_t _count;
+  uint8_t _index;
+  uint8_t _type;
+  bool _loop;
+  uint16_t _frame_ms;
+  uint16_t _remaining; // samples left in the current segment
+  uint16_t _end;       // exact value at the end of the current segment
+
+  // 32.32 fixed point value and its forward differences
+  int64_t _v, _d1, _d2, _d3;
+};
+
+#endif
@@ -0,0 +1,177 @@
+/*!
+ *  @file Adafruit_PWMTiming.cpp
+ *
+ *  With the default MODE2 setting the chip latches new LED values at the
+ *  I2C STOP, and a channel shows them from the next start of its PWM
+ *  period. The model therefore predicts the STOP from the time the
+ *  transfer starts, its bytes and the bus timing, then rounds up to a
+ *  period boundary. Boundaries are exact once a measured period start is
+ *  known and the expected half period later otherwise.
+ *
+ *  Writes queued on an Adafruit_PWMBus are stamped when the bus sends
+ *  them. One transfer joins its messages with repeated STARTs and ends
+ *  with one STOP, so all of them latch at the end of the whole transfer.
+ *
+ *  Calibrate the bus timing with extras/simavr_bench (bus cycles per byte)
+ *  or with a logic analyser. Not built with PCA9685_NO_TIMING.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMTiming.h"
+
+#ifndef PCA9685_NO_TIMING
+
+/*!
+ *  @brief  Instantiates a timing model with 400 kHz bus timing
+ */
+Adafruit_PWMTiming::Adafruit_PWMTiming()
+    : _pwm(NULL), _reference(0), _have_reference(false),
+      _ns_per_byte(PWM_TIMING_NS_PER_BYTE),
+      _overhead_us(PWM_TIMING_OVERHEAD_US) {
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+    _done[num] = 0;
+  resetStats();
+}
+
+/*!
+ *  @brief  Starts modelling the writes of a driver
+ *  @param  pwm The driver, one model per driver
+ */
+void Adafruit_PWMTiming::attach(Adafruit_PWMServoDriver &pwm) {
+  _pwm = &pwm;
+  pwm._timing = this;
+}
+
+/*!
+ *  @brief  Sets the bus timing used for predictions
+ *  @param  ns_per_byte Bus time per byte in nanoseconds, 22500 at 400 kHz,
+ * about 90000 at 100 kHz
+ *  @param  overhead_us Fixed cost of each write in microseconds
+ */
+void Adafruit_PWMTiming::setBusTiming(uint32_t ns_per_byte,
+                                      uint16_t overhead_us) {
+  _ns_per_byte = ns_per_byte;
+  _overhead_us = overhead_us;
+}
+
+/*!
+ *  @brief  Anchors the PWM period boundaries, e.g. to a captured rising
+ * edge of a channel with ON tick 0
+ *  @param  edge_us Time of a period start in microseconds, micros() clock
+ */
+void Adafruit_PWMTiming::setPhaseReference(uint32_t edge_us) {
+  _reference = edge_us;
+  _have_reference = true;
+}
+
+/*!
+ *  @brief  Gets the PWM period from the prescale and oscillator frequency
+ *  @return period in microseconds, 0 if not attached
+ */
+uint32_t Adafruit_PWMTiming::periodMicros() {
+  if (!_pwm)
+    return 0;
+  // 4096 ticks at a 16.16 ticks per microsecond factor
+  return (4096UL << 16) / _pwm->microsecondsFactor();
+}
+
+/*!
+ *  @brief  Predicts when the last value written to a channel appears at the
+ * pin: the start of the first PWM period using it
+ *  @param  num One of the PWM output pins, from 0 to 15
+ *  @return time in microseconds, micros() clock, 0 if nothing was written
+ * or the last write is still queued on a bus
+ */
+uint32_t Adafruit_PWMTiming::predictOutputTime(uint8_t num) {
+  if (num >= PCA9685_NUM_CHANNELS || !_done[num])
+    return 0;
+  uint32_t period = periodMicros();
+  if (!period)
+    return 0;
+  uint32_t done = _done[num];
+  if (!_have_reference)
+    return done + period / 2;
+  // Signed, the reference may be a later edge than the write
+  int32_t into = (int32_t)(done - _reference) % (int32_t)period;
+  if (into < 0)
+    into += period;
+  return into ? done + (period - into) : done;
+}
+
+/*!
+ *  @brief  Compares a measured output time with the prediction, and takes
+ * it as the new phase reference
+ *  @param  num The channel that was measured
+ *  @param  at_us Time the new value was seen at the pin, micros() clock
+ */
+void Adafruit_PWMTiming::measured(uint8_t num, uint32_t at_us) {
+  uint32_t predicted = predictOutputTime(num);
+  if (predicted) {
+    int32_t error = (int32_t)(at_us - predicted);
+    uint32_t abs_error = error < 0 ? -error : error;
+    _count++;
+    _error_sum += error;
+    if (abs_error > _error_max)
+      _error_max = abs_error;
+  }
+  setPhaseReference(at_us);
+}
+
+/*!
+ *  @brief  Clears the error statistics
+ */
+void Adafruit_PWMTiming::resetStats() {
+  _count = 0;
+  _error_sum = 0;
+  _error_max = 0;
+}
+
+/*!
+ *  @brief  Records a write about to go out in a transfer
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes
+ *  @param  started Time the transfer starts, micros() clock
+ *  @param  bytes Bytes of the whole transfer, with the address byte of
+ * each message
+ */
+void Adafruit_PWMTiming::sent(const uint8_t *buffer, uint8_t len,
+                              uint32_t started, uint16_t bytes) {
+  uint32_t done =
+      started + _overhead_us + (uint64_t)bytes * _ns_per_byte / 1000;
+  stamp(buffer, len, done ? done : 1); // 0 means nothing sent
+}
+
+/*!
+ *  @brief  Records a write queued on a bus, predicted once it is sent
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes
+ */
+void Adafruit_PWMTiming::queued(const uint8_t *buffer, uint8_t len) {
+  stamp(buffer, len, 0);
+}
+
+/*!
+ *  @brief  Sets the predicted end of the write of the channels in a buffer
+ *  @param  buffer Register address followed by the register values
+ *  @param  len Length of the buffer in bytes
+ *  @param  done Predicted STOP time, 0 while not sent
+ */
+void Adafruit_PWMTiming::stamp(const uint8_t *buffer, uint8_t len,
+                               uint32_t done) {
+  uint8_t first, count;
+  if (buffer[0] == PCA9685_ALLLED_ON_L) {
+    first = 0;
+    count = PCA9685_NUM_CHANNELS;
+  } else if (buffer[0] >= PCA9685_LED0_ON_L) {
+    first = (buffer[0] - PCA9685_LED0_ON_L) / 4;
+    count = (len - 1) / 4;
+  } else {
+    return;
+  }
+  for (uint8_t num = first;
+       num < first + count && num < PCA9685_NUM_CHANNELS; num++)
+    _done[num] = done;
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*!
+ *  @file Adafruit_PWMTiming.h
+ *
+ *  Predicts when a value written to a channel shows up at the pin, for
+ *  control loops that compensate for output latency, and keeps statistics
+ *  of the prediction error against measured output times.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMTiming_H
+#define _ADAFRUIT_PWMTiming_H
+
+#include "Adafruit_PWMBus.h"
+
+/** Default bus time per byte: 9 SCL periods at 400 kHz */
+#define PWM_TIMING_NS_PER_BYTE 22500
+/** Default fixed cost of a write: start, stop and driver overhead */
+#define PWM_TIMING_OVERHEAD_US 20
+
+/*!
+ *  @brief  Class that models the write-to-output latency of one PCA9685
+ */
+class Adafruit_PWMTiming {
+public:
+  Adafruit_PWMTiming();
+
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void setBusTiming(uint32_t ns_per_byte, uint16_t overhead_us);
+  void setPhaseReference(uint32_t edge_us);
+  uint32_t periodMicros();
+  uint32_t predictOutputTime(uint8_t num);
+  void measured(uint8_t num, uint32_t at_us);
+  void resetStats();
+
+  /*!
+   *  @brief  Number of measurements compared against predictions
+   *  @return measurement count
+   */
+  uint32_t count() const { return _count; }
+
+  /*!
+   *  @brief  Mean of measured minus predicted time, positive when outputs
+   * change later than predicted
+   *  @return mean error in microseconds
+   */
+  int32_t meanError() const {
+    return _count ? (int32_t)(_error_sum / (int32_t)_count) : 0;
+  }
+
+  /*!
+   *  @brief  Largest absolute prediction error
+   *  @return error in microseconds
+   */
+  uint32_t maxError() const { return _error_max; }
+
+private:
+  friend class Adafruit_PWMServoDriver;
+  friend class Adafruit_PWMBus;
+
+  void sent(const uint8_t *buffer, uint8_t len, uint32_t started,
+            uint16_t bytes);
+  void queued(const uint8_t *buffer, uint8_t len);
+  void stamp(const uint8_t *buffer, uint8_t len, uint32_t done);
+
+  Adafruit_PWMServoDriver *_pwm;
+  uint32_t _done[PCA9685_NUM_CHANNELS]; // predicted STOP of the last write
+  uint32_t _reference; // start of some PWM period, valid if _have_reference
+  bool _have_reference;
+  uint32_t _ns_per_byte;
+  uint16_t _overhead_us;
+  uint32_t _count;
+  int64_t _error_sum;
+  uint32_t _error_max;
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*!
+ *  @file Adafruit_PWMTrace.cpp
+ *
+ *  Latencies are counted in power of two microsecond buckets, so a
+ *  histogram costs 64 bytes per segment whatever the number of writes and
+ *  percentiles are resolved to within a factor of two (exact maxima are
+ *  kept separately).
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMTrace.h"
+
+static const char *const segment_names[PWM_TRACE_SEGMENTS] = {
+    "encode", "queue", "bus", "total"};
+
+/*!
+ *  @brief  Bucket of a latency: 0 for 0 us, else its bit length
+ *  @param  us Latency in microseconds
+ *  @return bucket index
+ */
+static uint8_t bucketOf(uint32_t us) {
+  uint8_t b = 0;
+  while (us && b < PWM_TRACE_BUCKETS - 1) {
+    us >>= 1;
+    b++;
+  }
+  return b;
+}
+
+/*!
+ *  @brief  Instantiates empty histograms
+ */
+Adafruit_PWMTrace::Adafruit_PWMTrace() { reset(); }
+
+/*!
+ *  @brief  Starts recording the writes of a driver, only has an effect
+ * when built with PCA9685_ENABLE_TRACING
+ *  @param  pwm The driver, one trace per driver
+ */
+void Adafruit_PWMTrace::attach(Adafruit_PWMServoDriver &pwm) {
+#ifdef PCA9685_ENABLE_TRACING
+  pwm._trace = this;
+#else
+  (void)pwm;
+#endif
+}
+
+/*!
+ *  @brief  Adds one finished write to the histograms
+ *  @param  trace Timestamps of the write
+ */
+void Adafruit_PWMTrace::record(const pwm_trace_t *trace) {
+  uint32_t latency[PWM_TRACE_SEGMENTS];
+  latency[PWM_TRACE_ENCODE] = trace->encoded - trace->entry;
+  latency[PWM_TRACE_QUEUE] = trace->started - trace->encoded;
+  latency[PWM_TRACE_BUS] = trace->done - trace->started;
+  latency[PWM_TRACE_TOTAL] = trace->done - trace->entry;
+  for (uint8_t s = 0; s < PWM_TRACE_SEGMENTS; s++) {
+    _buckets[s][bucketOf(latency[s])]++;
+    if (latency[s] > _max[s])
+      _max[s] = latency[s];
+  }
+}
+
+/*!
+ *  @brief  Clears the histograms
+ */
+void Adafruit_PWMTrace::reset() {
+  for (uint8_t s = 0; s < PWM_TRACE_SEGMENTS; s++) {
+    _max[s] = 0;
+    for (uint8_t b = 0; b < PWM_TRACE_BUCKETS; b++)
+      _buckets[s][b] = 0;
+  }
+}
+
+/*!
+ *  @brief  Number of writes recorded
+ *  @return write count
+ */
+uint32_t Adafruit_PWMTrace::count() const {
+  uint32_t n = 0;
+  for (uint8_t b = 0; b < PWM_TRACE_BUCKETS; b++)
+    n += _buckets[PWM_TRACE_TOTAL][b];
+  return n;
+}
+
+/*!
+ *  @brief  Latency below which a share of the writes completed a segment
+ *  @param  segment One of pwm_trace_segment_t
+ *  @param  permille Share of the writes, 500 for p50, 990 for p99
+ *  @return upper bound of the bucket holding the percentile, at most the
+ * maximum seen, in microseconds
+ */
+uint32_t Adafruit_PWMTrace::percentile(uint8_t segment,
+                                       uint16_t permille) const {
+  uint32_t n = count();
+  if (!n)
+    return 0;
+  uint32_t rank = (uint64_t)n * permille / 1000;
+  if (rank == 0)
+    rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < PWM_TRACE_BUCKETS - 1; b++) {
+    seen += _buckets[segment][b];
+    if (seen >= rank)
+      return min(((uint32_t)1 << b) - 1, _max[segment]);
+  }
+  return _max[segment];
+}
+
+/*!
+ *  @brief  Prints a CSV table, one row per segment: name, writes, p50, p99
+ * and max in microseconds, then the bucket counts
+ *  @param  out Where to print, e.g. Serial
+ */
+void Adafruit_PWMTrace::printCSV(Print &out) const {
+  out.print("segment,count,p50_us,p99_us,max_us");
+  for (uint8_t b = 0; b < PWM_TRACE_BUCKETS; b++) {
+    // Bucket b holds latencies below 2^b, the last one everything above
+    out.print(b < PWM_TRACE_BUCKETS - 1 ? ",lt" : ",ge");
+    out.print(1UL << (b < PWM_TRACE_BUCKETS - 1 ? b : b - 1));
+  }
+  out.println("");
+  uint32_t n = count();
+  for (uint8_t s = 0; s < PWM_TRACE_SEGMENTS; s++) {
+    out.print(segment_names[s]);
+    out.print(",");
+    out.print((unsigned long)n);
+    out.print(",");
+    out.print((unsigned long)percentile(s, 500));
+    out.print(",");
+    out.print((unsigned long)percentile(s, 990));
+    out.print(",");
+    out.print((unsigned long)_max[s]);
+    for (uint8_t b = 0; b < PWM_TRACE_BUCKETS; b++) {
+      out.print(",");
+      out.print((unsigned long)_buckets[s][b]);
+    }
+    out.println("");
+  }
+}
+
+/*!
+ *  @brief  Writes the histograms in binary: 'P', 'T', version 1, segment
+ * count, bucket count, then per segment the maximum and the bucket counts,
+ * all 32 bit little endian
+ *  @param  out Where to write
+ */
+void Adafruit_PWMTrace::writeBinary(Print &out) const {
+  uint8_t header[5] = {'P', 'T', 1, PWM_TRACE_SEGMENTS, PWM_TRACE_BUCKETS};
+  out.write(header, sizeof(header));
+  for (uint8_t s = 0; s < PWM_TRACE_SEGMENTS; s++) {
+    for (int8_t b = -1; b < PWM_TRACE_BUCKETS; b++) {
+      uint32_t v = b < 0 ? _max[s] : _buckets[s][b];
+      uint8_t le[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16),
+                       (uint8_t)(v >> 24)};
+      out.write(le, sizeof(le));
+    }
+  }
+}
@@ -0,0 +1,102 @@
+/*!
+ *  @file Adafruit_PWMTrace.h
+ *
+ *  Optional end-to-end latency tracing of LED writes. Build with
+ *  PCA9685_ENABLE_TRACING and every write carries the time of the API call,
+ *  of encoding, of queueing, and of the start and end of its bus transfer
+ *  (in the bus queue entry when queued on an Adafruit_PWMBus). An
+ *  Adafruit_PWMTrace attached to a driver turns them into per chip
+ *  latency histograms.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMTrace_H
+#define _ADAFRUIT_PWMTrace_H
+
+#include "Adafruit_PWMServoDriver.h"
+
+#define PWM_TRACE_BUCKETS 16 /**< log2 buckets, the last one open ended */
+
+/*!
+ *  @brief  Latency segments of a write
+ */
+typedef enum {
+  PWM_TRACE_ENCODE, ///< API call to encoded register payload
+  PWM_TRACE_QUEUE,  ///< Encoded to bus transfer start
+  PWM_TRACE_BUS,    ///< Bus transfer start to STOP
+  PWM_TRACE_TOTAL,  ///< API call to STOP
+  PWM_TRACE_SEGMENTS
+} pwm_trace_segment_t;
+
+/*!
+ *  @brief  Timestamps of one write, micros() clock
+ */
+typedef struct {
+  uint32_t entry;    ///< Outermost API call
+  uint32_t encoded;  ///< Register payload ready
+  uint32_t enqueued; ///< Queued on the bus, or equal to 'encoded'
+  uint32_t started;  ///< Bus transfer started
+  uint32_t done;     ///< Bus transfer finished
+} pwm_trace_t;
+
+/*!
+ *  @brief  Class that aggregates the write latencies of one chip
+ */
+class Adafruit_PWMTrace {
+public:
+  Adafruit_PWMTrace();
+
+  void attach(Adafruit_PWMServoDriver &pwm);
+  void record(const pwm_trace_t *trace);
+  void reset();
+  uint32_t count() const;
+  uint32_t percentile(uint8_t segment, uint16_t permille) const;
+
+  /*!
+   *  @brief  Longest latency seen in a segment
+   *  @param  segment One of pwm_trace_segment_t
+   *  @return latency in microseconds
+   */
+  uint32_t maxLatency(uint8_t segment) const { return _max[segment]; }
+
+  void printCSV(Print &out) const;
+  void writeBinary(Print &out) const;
+
+private:
+  uint32_t _buckets[PWM_TRACE_SEGMENTS][PWM_TRACE_BUCKETS];
+  uint32_t _max[PWM_TRACE_SEGMENTS];
+};
+
+#ifdef PCA9685_ENABLE_TRACING
+/*!
+ *  @brief  Stamps the entry time of the outermost driver call in scope
+ */
+class Adafruit_PWMTraceEntry {
+public:
+  /*!
+   *  @brief  Stamps the entry time unless an outer call already did
+   *  @param  pwm The driver being called
+   */
+  Adafruit_PWMTraceEntry(Adafruit_PWMServoDriver *pwm)
+      : _pwm(pwm->_trace_entry ? NULL : pwm) {
+    if (_pwm)
+      _pwm->_trace_entry = (micros() - 1) | 1; // never 0, never late
+  }
+  ~Adafruit_PWMTraceEntry() {
+    if (_pwm)
+      _pwm->_trace_entry = 0;
+  }
+
+private:
+  Adafruit_PWMServoDriver *_pwm;
+};
+
+/** Stamps the API entry time for the writes made by this call */
+#define PCA9685_TRACE_ENTRY() Adafruit_PWMTraceEntry _pca9685_trace(this)
+#else
+#define PCA9685_TRACE_ENTRY()                                                  \
+  do {                                                                         \
+  } while (0) /**< Tracing disabled */
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+/*!
+ *  @file Adafruit_PWMUpsampler.cpp
+ *
+ *  Frame-rate upsampling. Output frames are rendered a short delay behind
+ *  real time, so that the render time normally falls between the two most
+ *  recent received frames and can be interpolated instead of extrapolated.
+ *  The delay follows the measured input interval and is capped by the
+ *  maximum latency setting; past the newest frame the output simply holds.
+ *  The interpolation weights are computed once per output frame in 0.16
+ *  fixed point, leaving two (linear) or four (cubic) multiply-adds per
+ *  channel.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMUpsampler.h"
+
+/*!
+ *  @brief  Instantiates an upsampler writing into a frame
+ *  @param  frame The frame that receives the interpolated values
+ *  @param  interval Output frame interval in microseconds, e.g. 3333 for
+ * 300 Hz servos
+ *  @param  mask Channels to write, one bit per channel
+ */
+Adafruit_PWMUpsampler::Adafruit_PWMUpsampler(Adafruit_PWMFrame &frame,
+                                             uint32_t interval, uint16_t mask)
+    : _frame(&frame), _mask(mask), _cubic(false), _received(0), _newest(0),
+      _interval(interval), _max_latency(100000), _last_output(0) {}
+
+/*!
+ *  @brief  Sets the largest delay added between a received frame and its
+ * output. Lower values cut latency but hold the output when the producer is
+ * late
+ *  @param  latency Maximum added latency in microseconds, default 100 ms
+ */
+void Adafruit_PWMUpsampler::setMaxLatency(uint32_t latency) {
+  _max_latency = latency;
+}
+
+/*!
+ *  @brief  Receives a new frame of targets from the producer
+ *  @param  values Array of 16 OFF tick values, one per channel
+ *  @param  now Current time in microseconds, typically micros()
+ */
+void Adafruit_PWMUpsampler::push(const uint16_t *values, uint32_t now) {
+  _newest = (_newest + 1) % PWM_UPSAMPLER_HISTORY;
+  _time[_newest] = now;
+  memcpy(_values[_newest], values, sizeof(_values[_newest]));
+  if (_received < PWM_UPSAMPLER_HISTORY)
+    _received++;
+}
+
+/*!
+ *  @brief  Renders and flushes an output frame if one is due
+ *  @param  now Current time in microseconds, typically micros()
+ *  @return success of the frame flush, true if no frame was due
+ */
+bool Adafruit_PWMUpsampler::update(uint32_t now) {
+  if (!_received || now - _last_output < _interval)
+    return true;
+  _last_output = now;
+
+  // Ring positions from oldest (0) to newest (_received - 1)
+  uint8_t slot[PWM_UPSAMPLER_HISTORY];
+  for (uint8_t i = 0; i < _received; i++) {
+    slot[i] = (_newest + PWM_UPSAMPLER_HISTORY - (_received - 1 - i)) %
+              PWM_UPSAMPLER_HISTORY;
+  }
+  uint8_t last = _received - 1;
+
+  uint32_t delay = 0;
+  if (_received > 1)
+    delay = min(_time[slot[last]] - _time[slot[last - 1]], _max_latency);
+  uint32_t render = now - delay;
+
+  // Find the received pair surrounding the render time
+  uint8_t seg = last;
+  while (seg > 0 && (int32_t)(render - _time[slot[seg]]) < 0)
+    seg--;
+
+  const uint16_t *p1 = _values[slot[seg]];
+  if (seg == last || (int32_t)(render - _time[slot[seg]]) < 0) {
+    // Past the newest frame or before the oldest one: hold
+    for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+      if (_mask & (1U << num))
+        _frame->setPWM(num, 0, p1[num]);
+    }
+    return _frame->flush();
+  }
+
+  const uint16_t *p2 = _values[slot[seg + 1]];
+  uint32_t span = _time[slot[seg + 1]] - _time[slot[seg]];
+  uint32_t u = span ? ((uint64_t)(render - _time[slot[seg]]) << 16) / span : 0;
+  u = min(u, (uint32_t)0xFFFF);
+
+  if (!_cubic) {
+    for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+      if (!(_mask & (1U << num)))
+        continue;
+      int32_t delta = (int32_t)p2[num] - p1[num];
+      _frame->setPWM(num, 0, p1[num] + ((delta * (int32_t)u) >> 16));
+    }
+    return _frame->flush();
+  }
+
+  const uint16_t *p0 = seg > 0 ? _values[slot[seg - 1]] : p1;
+  const uint16_t *p3 = seg + 2 <= last ? _values[slot[seg + 2]] : p2;
+
+  // Catmull-Rom basis weights in 0.16 fixed point, they sum to 65536
+  int32_t u2 = (u * u) >> 16;
+  int32_t u3 = (u2 * u) >> 16;
+  int32_t w0 = (-u3 + 2 * u2 - (int32_t)u) / 2;
+  int32_t w1 = (3 * u3 - 5 * u2 + 2 * 65536) / 2;
+  int32_t w2 = (-3 * u3 + 4 * u2 + (int32_t)u) / 2;
+  int32_t w3 = (u3 - u2) / 2;
+
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    if (!(_mask & (1U << num)))
+      continue;
+    int32_t v = (w0 * p0[num] + w1 * p1[num] + w2 * p2[num] + w3 * p3[num] +
+                 32768) >>
+                16;
+    _frame->setPWM(num, 0, constrain(v, 0, 4095));
+  }
+  return _frame->flush();
+}
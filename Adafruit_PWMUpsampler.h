@@ -0,0 +1,47 @@
+/*!
+ *  @file Adafruit_PWMUpsampler.h
+ *
+ *  Interpolates channel targets received at a low rate into frames at the
+ *  output rate of one PCA9685.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMUpsampler_H
+#define _ADAFRUIT_PWMUpsampler_H
+
+#include "Adafruit_PWMFrame.h"
+
+#define PWM_UPSAMPLER_HISTORY 4 /**< Received frames kept for interpolation */
+
+/*!
+ *  @brief  Class that upsamples slow target frames into smooth output frames
+ */
+class Adafruit_PWMUpsampler {
+public:
+  Adafruit_PWMUpsampler(Adafruit_PWMFrame &frame, uint32_t interval,
+                        uint16_t mask = 0xFFFF);
+
+  void setMaxLatency(uint32_t latency);
+  /*!
+   *  @brief  Selects cubic (Catmull-Rom) instead of linear interpolation
+   *  @param  cubic true for cubic, false for linear
+   */
+  void setCubic(bool cubic) { _cubic = cubic; }
+
+  void push(const uint16_t *values, uint32_t now);
+  bool update(uint32_t now);
+
+private:
+  Adafruit_PWMFrame *_frame;
+  uint16_t _mask;
+  bool _cubic;
+  uint8_t _received; // frames in history, saturates at the history size
+  uint8_t _newest;   // ring index of the newest frame
+  uint32_t _interval;
+  uint32_t _max_latency;
+  uint32_t _last_output;
+  uint32_t _time[PWM_UPSAMPLER_HISTORY];
+  uint16_t _values[PWM_UPSAMPLER_HISTORY][PCA9685_NUM_CHANNELS];
+};
+
+#endif
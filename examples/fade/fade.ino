@@ -0,0 +1,53 @@
+/***************************************************
+  This is an example for our Adafruit 16-channel PWM & Servo driver
+  Fade test - this will breathe 16 LEDs with staggered fades, all computed
+  by the library and sent to the chip in batched writes
+
+  Pick one up today in the adafruit shop!
+  ------> http://www.adafruit.com/products/815
+
+  These drivers use I2C to communicate, 2 pins are required to
+  interface.
+
+  Adafruit invests time and resources providing this open source code,
+  please support Adafruit and open-source hardware by purchasing
+  products from Adafruit!
+
+  BSD license, all text above must be included in any redistribution
+ ****************************************************/
+
+#include <Wire.h>
+#include <Adafruit_PWMServoDriver.h>
+#include <Adafruit_PWMFader.h>
+
+Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver();
+// Pending channel values, sent to the chip only when they change
+Adafruit_PWMFrame frame = Adafruit_PWMFrame(pwm);
+Adafruit_PWMFader fader = Adafruit_PWMFader(frame);
+
+#define FADE_MS 1500 // length of each fade up or down
+
+void setup() {
+  Serial.begin(9600);
+  Serial.println("16 channel fade test!");
+
+  pwm.begin();
+  pwm.setPWMFreq(1000);
+  Wire.setClock(400000);
+
+  // Start every LED at a different point so they breathe in a wave
+  for (uint8_t led = 0; led < 16; led++) {
+    fader.fadeTo(led, 4095, FADE_MS / 16 * (led + 1), PWM_FADE_EXPONENTIAL);
+  }
+}
+
+void loop() {
+  fader.update(millis());
+
+  for (uint8_t led = 0; led < 16; led++) {
+    if (!fader.isFading(led)) {
+      uint16_t target = fader.getValue(led) ? 0 : 4095;
+      fader.fadeTo(led, target, FADE_MS, PWM_FADE_EXPONENTIAL);
+    }
+  }
+}
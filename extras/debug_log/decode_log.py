@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Decode the PCA9685 driver binary debug log.
+
+Build the library with ENABLE_DEBUG_OUTPUT, call
+Adafruit_PWMDebugLog::drain(Serial) from loop(), capture the serial output
+to a file (or read the port directly) and decode it:
+
+    extras/debug_log/decode_log.py capture.bin
+    extras/debug_log/decode_log.py /dev/ttyACM0
+
+Records are 11 bytes: 0xA5, event id, 8 bit argument, two little endian
+16 bit arguments and a little endian 32 bit micros() timestamp. Bytes that
+do not start a valid record (e.g. ordinary Serial.print() text) are skipped.
+"""
+
+import struct
+import sys
+
+SYNC = 0xA5
+RECORD = struct.Struct("<BBBHHI")
+
+# Event id -> (name, formatter of (arg, a, b)), keep in sync with
+# pwm_log_event_t in Adafruit_PWMDebugLog.h
+EVENTS = {
+    0: ("dropped", lambda arg, a, b: "lost=%d" % a),
+    1: ("mode1", lambda arg, a, b: "value=0x%02X" % arg),
+    2: ("mode2", lambda arg, a, b: "value=0x%02X" % arg),
+    3: ("freq", lambda arg, a, b: "hz=%d prescale=%d" % (a, arg)),
+    4: ("prescale", lambda arg, a, b: "prescale=%d ticks_per_us=%.6f"
+        % (arg, ((b << 16) | a) / 65536.0)),
+    5: ("set_pwm", lambda arg, a, b: "ch=%d on=%d off=%d" % (arg, a, b)),
+    6: ("burst", lambda arg, a, b: "first=%d count=%d" % (arg, a)),
+    7: ("micros", lambda arg, a, b: "ch=%d us=%d off=%d" % (arg, a, b)),
+}
+
+
+def records(stream):
+    """Yields (time, id, arg, a, b) for every valid record in the stream."""
+    buf = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while len(buf) >= RECORD.size:
+            if buf[0] != SYNC or buf[1] not in EVENTS:
+                buf = buf[1:]
+                continue
+            _, ev, arg, a, b, t = RECORD.unpack_from(buf)
+            buf = buf[RECORD.size:]
+            yield t, ev, arg, a, b
+
+
+def main():
+    if len(sys.argv) > 1:
+        stream = open(sys.argv[1], "rb", buffering=0)
+    else:
+        stream = sys.stdin.buffer
+    start = None
+    last = 0
+    wraps = 0
+    for t, ev, arg, a, b in records(stream):
+        # micros() wraps every ~71 minutes
+        if t < last:
+            wraps += 1
+        last = t
+        t += wraps << 32
+        if start is None:
+            start = t
+        name, fmt = EVENTS[ev]
+        print("%12.3f ms  %-9s %s" % ((t - start) / 1000.0, name,
+                                      fmt(arg, a, b)))
+
+
+if __name__ == "__main__":
+    main()
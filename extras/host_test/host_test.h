@@ -0,0 +1,46 @@
+/*!
+ *  @file host_test.h
+ *
+ *  Check macros of the host tests. A failed check prints its location and
+ *  the test carries on, so one run shows every failure; HOST_TEST_END()
+ *  then makes the program exit non-zero.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _HOST_TEST_H
+#define _HOST_TEST_H
+
+#include <stdio.h>
+
+static int host_checks;   ///< Checks run
+static int host_failures; ///< Checks failed
+
+/** Checks that a condition holds */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    host_checks++;                                                             \
+    if (!(cond)) {                                                             \
+      host_failures++;                                                         \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);         \
+    }                                                                          \
+  } while (0)
+
+/** Checks that two integer values are equal, printing both if not */
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    long long _a = (long long)(a), _b = (long long)(b);                        \
+    host_checks++;                                                             \
+    if (_a != _b) {                                                            \
+      host_failures++;                                                         \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__,      \
+             __LINE__, #a, #b, _a, _b);                                        \
+    }                                                                          \
+  } while (0)
+
+/** Prints the totals of a test program and returns its exit status */
+#define HOST_TEST_END()                                                        \
+  (printf("%s: %d checks, %d failed\n", __FILE__, host_checks,                 \
+          host_failures),                                                      \
+   host_failures ? 1 : 0)
+
+#endif
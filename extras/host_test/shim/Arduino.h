@@ -0,0 +1,77 @@
+/*!
+ *  @file Arduino.h
+ *
+ *  Host stand-in for the Arduino core, just what the library needs, so it
+ *  builds as a normal Linux program. micros() returns 'host_micros', which
+ *  the tests set, so time dependent code runs the same on every run.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+
+// Same macros as the Arduino AVR core
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+extern uint32_t host_micros; ///< Current time of micros(), set by the tests
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis(void);
+unsigned long micros(void);
+static inline void noInterrupts(void) {}
+static inline void interrupts(void) {}
+
+/*!
+ *  @brief  Byte sink, as in the Arduino core, with the print overloads the
+ * library reports use
+ */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--)
+      n += write(*buffer++);
+    return n;
+  }
+  size_t print(const char *str) {
+    return write((const uint8_t *)str, strlen(str));
+  }
+  size_t print(unsigned long n) {
+    char buf[21];
+    snprintf(buf, sizeof(buf), "%lu", n);
+    return print(buf);
+  }
+  size_t println(const char *str) { return print(str) + print("\r\n"); }
+  size_t println(unsigned long n) { return print(n) + print("\r\n"); }
+};
+
+/*!
+ *  @brief  Byte source, as in the Arduino core
+ */
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+#endif
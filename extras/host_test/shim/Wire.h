@@ -0,0 +1,19 @@
+/*!
+ *  @file Wire.h
+ *
+ *  Placeholder TwoWire type, the host tests model the chips in the
+ *  Adafruit_I2CDevice shim.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _HOST_WIRE_H
+#define _HOST_WIRE_H
+
+/*!
+ *  @brief  Empty bus handle
+ */
+class TwoWire {};
+
+extern TwoWire Wire;
+
+#endif
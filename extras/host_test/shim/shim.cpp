@@ -0,0 +1,58 @@
+/*!
+ *  @file shim.cpp
+ *
+ *  Runtime pieces of the host shim: the test clock and the register model.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_I2CDevice.h"
+
+TwoWire Wire;
+uint32_t host_micros;
+uint8_t host_regs[128][256];
+uint32_t host_writes;
+
+void delay(unsigned long ms) { host_micros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { host_micros += us; }
+unsigned long millis(void) { return host_micros / 1000; }
+unsigned long micros(void) { return host_micros; }
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire)
+    : _addr(addr & 0x7F) {
+  (void)theWire;
+}
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  (void)addr_detect;
+  return true;
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  if (prefix_len + len > maxBufferSize() || prefix_len + len == 0)
+    return false;
+  uint8_t data[32];
+  if (prefix_len)
+    memcpy(data, prefix_buffer, prefix_len);
+  memcpy(data + prefix_len, buffer, len);
+  for (size_t i = 1; i < prefix_len + len; i++)
+    host_regs[_addr][(uint8_t)(data[0] + i - 1)] = data[i];
+  host_writes++;
+  return true;
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len,
+                                         uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  (void)stop;
+  if (!write_len)
+    return false;
+  uint8_t reg = write_buffer[0];
+  for (size_t i = 0; i < read_len; i++)
+    read_buffer[i] = host_regs[_addr][(uint8_t)(reg + i)];
+  return true;
+}
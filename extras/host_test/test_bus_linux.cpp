@@ -0,0 +1,131 @@
+/*!
+ *  @file test_bus_linux.cpp
+ *
+ *  Adafruit_PWMBus with the Linux i2c-dev transfer function and a fake
+ *  ioctl(): the writes of several chips go out as the messages of one
+ *  I2C_RDWR call, in order, with the chip address, write flags and bytes
+ *  of each write, split only at I2C_RDWR_IOCTL_MAX_MSGS.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMBusLinux.h"
+#include "Adafruit_PWMServoDriver.h"
+#include "host_test.h"
+
+#define MAX_CALLS 8
+
+/*!
+ *  @brief  One intercepted I2C_RDWR call, messages copied out
+ */
+typedef struct {
+  unsigned long request;
+  uint32_t nmsgs;
+  uint16_t addr[I2C_RDWR_IOCTL_MAX_MSGS];
+  uint16_t flags[I2C_RDWR_IOCTL_MAX_MSGS];
+  uint16_t len[I2C_RDWR_IOCTL_MAX_MSGS];
+  uint8_t buf[I2C_RDWR_IOCTL_MAX_MSGS][1 + 4 * PCA9685_NUM_CHANNELS];
+} ioctl_call_t;
+
+static ioctl_call_t calls[MAX_CALLS];
+static uint8_t ncalls;
+
+static int fake_ioctl(int fd, unsigned long request, void *arg) {
+  CHECK_EQ(fd, 3);
+  if (ncalls == MAX_CALLS)
+    return -1;
+  ioctl_call_t *c = &calls[ncalls++];
+  struct i2c_rdwr_ioctl_data *data = (struct i2c_rdwr_ioctl_data *)arg;
+  c->request = request;
+  c->nmsgs = data->nmsgs;
+  for (uint32_t i = 0; i < data->nmsgs && i < I2C_RDWR_IOCTL_MAX_MSGS; i++) {
+    c->addr[i] = data->msgs[i].addr;
+    c->flags[i] = data->msgs[i].flags;
+    c->len[i] = data->msgs[i].len;
+    memcpy(c->buf[i], data->msgs[i].buf,
+           min(data->msgs[i].len, (uint16_t)sizeof(c->buf[i])));
+  }
+  return data->nmsgs;
+}
+
+// Checks one message against a single channel write
+static void check_led(const ioctl_call_t *c, uint8_t i, uint8_t addr,
+                      uint8_t num, uint16_t on, uint16_t off) {
+  CHECK_EQ(c->addr[i], addr);
+  CHECK_EQ(c->flags[i], 0);
+  CHECK_EQ(c->len[i], 5);
+  CHECK_EQ(c->buf[i][0], PCA9685_LED0_ON_L + 4 * num);
+  CHECK_EQ(c->buf[i][1] | c->buf[i][2] << 8, on);
+  CHECK_EQ(c->buf[i][3] | c->buf[i][4] << 8, off);
+}
+
+int main() {
+  static const uint8_t addrs[3] = {0x40, 0x41, 0x5A};
+  Adafruit_PWMServoDriver pwm[3] = {Adafruit_PWMServoDriver(addrs[0]),
+                                    Adafruit_PWMServoDriver(addrs[1]),
+                                    Adafruit_PWMServoDriver(addrs[2])};
+  static uint8_t pool[64 * 5];
+  static pwm_bus_msg_t msgs[64];
+  Adafruit_PWMBus bus(pool, sizeof(pool), msgs, 64);
+  pwm_linux_i2c_t linux_bus = {3, fake_ioctl};
+  bus.setTransfer(pwm_linux_i2c_transfer, &linux_bus,
+                  I2C_RDWR_IOCTL_MAX_MSGS);
+  for (uint8_t c = 0; c < 3; c++) {
+    pwm[c].begin();
+    bus.attach(pwm[c]);
+  }
+
+  // Interleaved writes of three chips, one of them a burst
+  uint32_t writes = host_writes;
+  pwm[0].setPWM(3, 0, 300);
+  pwm[2].setPWM(15, 4096, 0);
+  uint16_t on[2] = {0, 100};
+  uint16_t off[2] = {1500, 2100};
+  pwm[1].setPWMBurst(4, 2, on, off);
+  pwm[0].setPin(0, 0);
+  CHECK_EQ(bus.pending(), 4);
+  CHECK_EQ(ncalls, 0);
+  CHECK(bus.flush());
+  CHECK_EQ(host_writes, writes); // nothing went to the devices directly
+  CHECK_EQ(ncalls, 1);
+  CHECK_EQ(calls[0].request, I2C_RDWR);
+  CHECK_EQ(calls[0].nmsgs, 4);
+  check_led(&calls[0], 0, addrs[0], 3, 0, 300);
+  check_led(&calls[0], 1, addrs[2], 15, 4096, 0);
+  CHECK_EQ(calls[0].addr[2], addrs[1]);
+  CHECK_EQ(calls[0].flags[2], 0);
+  CHECK_EQ(calls[0].len[2], 9);
+  static const uint8_t burst[9] = {PCA9685_LED0_ON_L + 16, 0, 0, 0xDC, 0x05,
+                                   100, 0, 0x34, 0x08};
+  CHECK(memcmp(calls[0].buf[2], burst, sizeof(burst)) == 0);
+  check_led(&calls[0], 3, addrs[0], 0, 0, 4096);
+  CHECK_EQ(bus.pending(), 0);
+
+  // 48 writes: one full I2C_RDWR and the rest in a second one
+  ncalls = 0;
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++) {
+    for (uint8_t c = 0; c < 3; c++)
+      pwm[c].setPWM(num, c, 1000 + 16 * c + num);
+  }
+  CHECK_EQ(bus.pending(), 48);
+  CHECK(bus.flush());
+  CHECK_EQ(ncalls, 2);
+  CHECK_EQ(calls[0].nmsgs, I2C_RDWR_IOCTL_MAX_MSGS);
+  CHECK_EQ(calls[1].nmsgs, 48 - I2C_RDWR_IOCTL_MAX_MSGS);
+  for (uint8_t i = 0; i < 48; i++) {
+    const ioctl_call_t *c = &calls[i / I2C_RDWR_IOCTL_MAX_MSGS];
+    uint8_t chip = i % 3, num = i / 3;
+    check_led(c, i % I2C_RDWR_IOCTL_MAX_MSGS, addrs[chip], num, chip,
+              1000 + 16 * chip + num);
+  }
+
+  // A failed ioctl fails the flush
+  ncalls = MAX_CALLS;
+  pwm[1].setPWM(0, 0, 0);
+  CHECK(!bus.flush());
+
+  // Over the limit is refused rather than cut short
+  CHECK(!pwm_linux_i2c_transfer(&linux_bus, msgs,
+                                I2C_RDWR_IOCTL_MAX_MSGS + 1));
+  return HOST_TEST_END();
+}
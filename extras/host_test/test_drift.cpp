@@ -0,0 +1,181 @@
+/*!
+ *  @file test_drift.cpp
+ *
+ *  Adafruit_PWMDrift fed with a synthetic edge stream of an oscillator
+ *  that drifts, with jitter, missed edges and glitches: the estimate
+ *  follows the true frequency, tracked pulses are rewritten with the right
+ *  tick values, a start far off (27 MHz taken as 25 MHz) is recovered, and
+ *  channels written any other way are released.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMDrift.h"
+#include "Adafruit_PWMFrame.h"
+#include "host_test.h"
+
+#define ADDR 0x40
+
+/*!
+ *  @brief  Rising edges of a channel with ON tick 0, at the true oscillator
+ */
+typedef struct {
+  double freq;   // true oscillator frequency, Hz
+  double t;      // time of the last edge, us
+  uint32_t seed; // jitter and glitch generator
+  uint32_t n;    // edges generated
+} edges_t;
+
+static uint32_t rnd(edges_t *e) {
+  e->seed = e->seed * 1103515245 + 12345;
+  return e->seed >> 16;
+}
+
+// Runs the stream for some seconds, the frequency moving linearly to
+// 'to', with one update() per second
+static void run(edges_t *e, Adafruit_PWMDrift &drift, uint8_t prescale,
+                double seconds, double to) {
+  double from = e->freq;
+  double end = e->t + seconds * 1e6;
+  double next_update = e->t + 1e6;
+  double start = e->t;
+  while (e->t < end) {
+    e->freq = from + (to - from) * (e->t - start) / (end - start);
+    e->t += 4096.0 * (prescale + 1) * 1e6 / e->freq;
+    e->n++;
+    if (e->n % 13 == 5)
+      continue; // missed edge
+    host_micros = (uint32_t)(e->t + (int)(rnd(e) % 17) - 8); // +-8 us
+    drift.edge(host_micros);
+    if (e->n % 50 == 20) {
+      host_micros += 3000 + rnd(e) % 5000; // glitch
+      drift.edge(host_micros);
+    }
+    if (e->t >= next_update) {
+      CHECK(drift.update());
+      next_update += 1e6;
+    }
+  }
+}
+
+static uint16_t off_register(uint8_t num) {
+  const uint8_t *r = &host_regs[ADDR][PCA9685_LED0_ON_L + 4 * num];
+  return r[2] | r[3] << 8;
+}
+
+static uint16_t expected_ticks(double freq, uint8_t prescale, uint16_t us) {
+  return (uint16_t)(us * freq / (prescale + 1) / 1e6);
+}
+
+static void check_freq(Adafruit_PWMServoDriver &pwm, double freq) {
+  double error = (pwm.getOscillatorFrequency() - freq) / freq;
+  CHECK(error > -0.001 && error < 0.001);
+  if (error <= -0.001 || error >= 0.001)
+    printf("  oscillator %lu, true %.0f\n",
+           (unsigned long)pwm.getOscillatorFrequency(), freq);
+}
+
+int main() {
+  // Thermal drift around the expected frequency
+  {
+    Adafruit_PWMServoDriver pwm(ADDR);
+    pwm.begin();
+    pwm.setOscillatorFrequency(25000000);
+    pwm.setPWMFreq(50);
+    uint8_t prescale = pwm.readPrescale();
+    Adafruit_PWMDrift drift;
+    drift.attach(pwm);
+    pwm.writeMicroseconds(0, 1500);
+    pwm.writeMicroseconds(5, 1000);
+    CHECK_EQ(drift.trackedMask(), 0x0021);
+
+    edges_t e = {25400000, 0, 1, 0};
+    run(&e, drift, prescale, 30, 25400000);
+    check_freq(pwm, e.freq);
+    run(&e, drift, prescale, 120, 25150000);
+    check_freq(pwm, e.freq);
+    CHECK(drift.accepted() > 5000);
+    CHECK(drift.rejected() > 100); // the glitches
+    uint16_t ticks = off_register(0);
+    uint16_t want = expected_ticks(e.freq, prescale, 1500);
+    CHECK(ticks >= want - 1 && ticks <= want + 1);
+    ticks = off_register(5);
+    want = expected_ticks(e.freq, prescale, 1000);
+    CHECK(ticks >= want - 1 && ticks <= want + 1);
+  }
+
+  // 27 MHz chip taken as 25 MHz: every sample is 7% off and rejected at
+  // first, until the rejected ones replace the estimate
+  {
+    Adafruit_PWMServoDriver pwm(ADDR);
+    pwm.begin();
+    pwm.setOscillatorFrequency(25000000);
+    pwm.setPWMFreq(50);
+    uint8_t prescale = pwm.readPrescale();
+    Adafruit_PWMDrift drift;
+    drift.attach(pwm);
+    pwm.writeMicroseconds(2, 2000);
+
+    edges_t e = {27000000, 1e9, 7, 0};
+    run(&e, drift, prescale, 10, 27000000);
+    CHECK(drift.rejected() >= PWM_DRIFT_REACQUIRE);
+    CHECK(drift.accepted() > 300);
+    check_freq(pwm, e.freq);
+    uint16_t ticks = off_register(2);
+    uint16_t want = expected_ticks(e.freq, prescale, 2000);
+    CHECK(ticks >= want - 1 && ticks <= want + 1);
+  }
+
+  // Channels written with anything but a pulse length are released
+  {
+    Adafruit_PWMServoDriver pwm(ADDR);
+    pwm.begin();
+    pwm.setPWMFreq(50);
+    Adafruit_PWMDrift drift;
+    drift.attach(pwm);
+    uint16_t us[PCA9685_NUM_CHANNELS];
+    for (uint8_t i = 0; i < PCA9685_NUM_CHANNELS; i++)
+      us[i] = 1000 + 50 * i;
+
+    pwm.writeMicrosecondsBatch(0, PCA9685_NUM_CHANNELS, us);
+    CHECK_EQ(drift.trackedMask(), 0xFFFF);
+    pwm.setPWM(0, 0, 100);
+    CHECK_EQ(drift.trackedMask(), 0xFFFE);
+    pwm.setPin(1, 2000);
+    CHECK_EQ(drift.trackedMask(), 0xFFFC);
+    uint16_t on[2] = {0, 0}, off[2] = {10, 20};
+    pwm.setPWMBurst(2, 2, on, off);
+    CHECK_EQ(drift.trackedMask(), 0xFFF0);
+    pwm.setPWMMask(0x00F0, 0, 300);
+    CHECK_EQ(drift.trackedMask(), 0xFF00);
+    uint8_t channels[2] = {8, 9};
+    uint16_t phases[2] = {0, 180};
+    pwm.setPhasedGroup(channels, 2, 1000, phases);
+    CHECK_EQ(drift.trackedMask(), 0xFC00);
+    Adafruit_PWMFrame frame(pwm);
+    frame.setPWM(10, 0, 400);
+    frame.flush();
+    CHECK_EQ(drift.trackedMask(), 0xF800);
+
+    // Pulse lengths keep their channels tracked, on every path
+    pwm.writeMicroseconds(0, 1500);
+    pwm.writeMicrosecondsMask(0x0006, us);
+    CHECK_EQ(drift.trackedMask(), 0xF807);
+    pwm.setPWMMask(0xFFFF, 0, 0);
+    CHECK_EQ(drift.trackedMask(), 0);
+
+#ifndef PCA9685_NO_BATCH
+    {
+      auto batch = pwm.beginBatch();
+      pwm.writeMicroseconds(3, 1500);
+      pwm.writeMicroseconds(4, 1500);
+      pwm.setPWM(4, 0, 0); // overrides the pulse before the commit
+    }
+    CHECK_EQ(drift.trackedMask(), 0x0008);
+#endif
+    pwm.writeMicroseconds(5, 1500);
+    pwm.setAllOff();
+    CHECK_EQ(drift.trackedMask(), 0);
+  }
+  return HOST_TEST_END();
+}
@@ -0,0 +1,148 @@
+/*!
+ *  @file test_mirror.cpp
+ *
+ *  Adafruit_PWMMirror streaming the writes of an active driver through a
+ *  loopback Stream into standby shadows: records survive corrupted and
+ *  lost bytes, ALL_LED writes fan out to every channel, and takeover()
+ *  rewrites only the diverged runs of a running chip, or restores the
+ *  configuration and all channels of a chip that was reset.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMMirror.h"
+#include "host_test.h"
+
+#define ADDR 0x40
+
+/*!
+ *  @brief  Byte queue written by the active mirror and read by the standby
+ */
+class Loopback : public Stream {
+public:
+  Loopback() : head(0), tail(0) {}
+  size_t write(uint8_t c) {
+    if (tail == sizeof(buf))
+      return 0;
+    buf[tail++] = c;
+    return 1;
+  }
+  int available() { return tail - head; }
+  int read() {
+    if (head == tail)
+      return -1;
+    int c = buf[head++];
+    if (head == tail)
+      head = tail = 0;
+    return c;
+  }
+  uint8_t buf[1024]; ///< Queued bytes
+  uint16_t head;     ///< Next byte to read
+  uint16_t tail;     ///< Next byte to write
+};
+
+static bool shadow_matches_chip(const pwm_mirror_state_t *st) {
+  return memcmp(st->leds, &host_regs[ADDR][PCA9685_LED0_ON_L],
+                4 * PCA9685_NUM_CHANNELS) == 0;
+}
+
+int main() {
+  Loopback link;
+  Adafruit_PWMMirror active;
+  static pwm_mirror_state_t states[2];
+  Adafruit_PWMMirror standby(states, 2);
+  active.setOutput(link);
+  standby.setInput(link);
+
+  // Configuration and channel writes of the active controller
+  Adafruit_PWMServoDriver pwm(ADDR);
+  active.attach(pwm);
+  pwm.begin();
+  pwm.setPWMFreq(50);
+  pwm.setPWMMask(0xFFFF, 0, 4096); // ALL_LED, fans out to every channel
+  CHECK(standby.poll() > 0);
+  const pwm_mirror_state_t *st = standby.state(ADDR);
+  CHECK(st != NULL);
+  CHECK_EQ(st->known, 0xFFFF);
+  CHECK_EQ(st->config & (PWM_MIRROR_MODE1 | PWM_MIRROR_PRESCALE),
+           PWM_MIRROR_MODE1 | PWM_MIRROR_PRESCALE);
+  CHECK_EQ(st->prescale, host_regs[ADDR][PCA9685_PRESCALE]);
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+    CHECK_EQ(st->leds[4 * num + 3], 0x10); // OFF_H full off bit
+  CHECK(standby.state(0x41) == NULL);
+
+  for (uint8_t num = 0; num < PCA9685_NUM_CHANNELS; num++)
+    pwm.setPWM(num, 0, 1000 + 10 * num);
+  uint16_t on[3] = {0, 0, 0}, off[3] = {300, 310, 320};
+  pwm.setPWMBurst(8, 3, on, off);
+  CHECK_EQ(standby.poll(), PCA9685_NUM_CHANNELS + 1);
+  CHECK(shadow_matches_chip(st));
+  CHECK_EQ(standby.errors(), 0);
+
+  // A corrupted byte drops its record only, the stream resyncs on the next
+  // sync byte
+  pwm.setPWM(2, 0, 222);
+  link.buf[link.tail - 2] ^= 0x01; // OFF_H
+  pwm.setPWM(3, 0, 333);
+  CHECK_EQ(standby.poll(), 1);
+  CHECK_EQ(standby.errors(), 1);
+  CHECK_EQ(st->leds[4 * 2 + 2] | st->leds[4 * 2 + 3] << 8, 1020);
+  CHECK_EQ(st->leds[4 * 3 + 2] | st->leds[4 * 3 + 3] << 8, 333);
+
+  // Lost bytes: a record cut short is dropped, the next one applies
+  pwm.setPWM(4, 0, 444);
+  link.tail -= 3;
+  pwm.setPWM(5, 0, 555);
+  pwm.setPWM(6, 0, 666);
+  standby.poll();
+  CHECK_EQ(standby.errors(), 2);
+  CHECK_EQ(st->leds[4 * 6 + 2] | st->leds[4 * 6 + 3] << 8, 666);
+
+  // Bring the shadow back in line with the chip
+  CHECK(active.sendSnapshot(pwm));
+  standby.poll();
+  CHECK(shadow_matches_chip(st));
+  uint32_t errors = standby.errors();
+
+  // Takeover of a running chip: channels 5, 6 and 12 changed behind the
+  // shadow, two runs, two writes and no configuration write
+  active.detach(pwm);
+  uint8_t saved[4 * PCA9685_NUM_CHANNELS];
+  memcpy(saved, st->leds, sizeof(saved));
+  host_regs[ADDR][PCA9685_LED0_ON_L + 4 * 5 + 2] ^= 0x0F;
+  host_regs[ADDR][PCA9685_LED0_ON_L + 4 * 6 + 0] = 0x33;
+  host_regs[ADDR][PCA9685_LED0_ON_L + 4 * 12 + 3] = 0x08;
+  uint8_t mode1 = host_regs[ADDR][PCA9685_MODE1];
+  Adafruit_PWMServoDriver takeover(ADDR);
+  takeover.beginBarebones();
+  uint32_t writes = host_writes;
+  CHECK(standby.takeover(takeover));
+  CHECK_EQ(host_writes - writes, 2);
+  CHECK_EQ(host_regs[ADDR][PCA9685_MODE1], mode1);
+  CHECK(memcmp(&host_regs[ADDR][PCA9685_LED0_ON_L], saved, sizeof(saved)) ==
+        0);
+
+  // Nothing diverged: nothing written
+  writes = host_writes;
+  CHECK(standby.takeover(takeover));
+  CHECK_EQ(host_writes, writes);
+
+  // Takeover of a chip that was reset: power-on MODE1 and PRESCALE, LEDs
+  // cleared; the configuration and every channel come back
+  memset(host_regs[ADDR], 0, 256);
+  host_regs[ADDR][PCA9685_MODE1] = MODE1_SLEEP | MODE1_ALLCAL;
+  host_regs[ADDR][PCA9685_PRESCALE] = 0x1E;
+  CHECK(standby.takeover(takeover));
+  CHECK_EQ(host_regs[ADDR][PCA9685_PRESCALE], st->prescale);
+  CHECK_EQ(host_regs[ADDR][PCA9685_MODE1] & ~MODE1_RESTART,
+           st->mode1 & ~MODE1_RESTART);
+  CHECK(memcmp(&host_regs[ADDR][PCA9685_LED0_ON_L], saved, sizeof(saved)) ==
+        0);
+
+  // A chip never seen cannot be taken over
+  Adafruit_PWMServoDriver other(0x41);
+  other.beginBarebones();
+  CHECK(!standby.takeover(other));
+  CHECK_EQ(standby.errors(), errors);
+  return HOST_TEST_END();
+}
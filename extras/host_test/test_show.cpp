@@ -0,0 +1,141 @@
+/*!
+ *  @file test_show.cpp
+ *
+ *  Adafruit_PWMShow replaying extras/show_compiler/example_show.json,
+ *  compiled by the Makefile: the registers follow the tracks frame by
+ *  frame, once and looped. Hand made shows check that a looped show
+ *  without delays does not block poll(), and that writes past the LED
+ *  registers or the bus buffer are skipped.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMShow.h"
+#include "example_show.h"
+#include "host_test.h"
+
+#define FRAME_US 20000UL
+// Ticks per microsecond of the example show: 25 MHz, prescale 121
+#define TICKS_PER_US (25000000.0 / 122 / 1e6)
+
+static uint16_t reg16(uint8_t addr, uint8_t reg) {
+  return host_regs[addr][reg] | host_regs[addr][reg + 1] << 8;
+}
+
+static uint16_t on_ticks(uint8_t addr, uint8_t num) {
+  return reg16(addr, PCA9685_LED0_ON_L + 4 * num);
+}
+
+static uint16_t off_ticks(uint8_t addr, uint8_t num) {
+  return reg16(addr, PCA9685_LED0_ON_L + 4 * num + 2);
+}
+
+static bool near(uint16_t ticks, double us) {
+  int32_t want = (int32_t)(us * TICKS_PER_US + 0.5);
+  return ticks + 1 >= want && ticks <= want + 1;
+}
+
+// Checks the outputs against the tracks at a time into the show
+static void check_tracks(uint32_t t_ms) {
+  double ch0 = t_ms < 1000 ? 1000 + t_ms : t_ms < 2000 ? 3000 - t_ms : 1000;
+  CHECK_EQ(on_ticks(0x40, 0), 0);
+  CHECK(near(off_ticks(0x40, 0), ch0));
+  CHECK(near(off_ticks(0x40, 1), 3000 - ch0));
+  CHECK(near(off_ticks(0x40, 3), 1500));
+  bool full_on = t_ms >= 500 && t_ms < 1500;
+  CHECK_EQ(on_ticks(0x41, 8), full_on ? 4096 : 0);
+  CHECK_EQ(off_ticks(0x41, 8), full_on ? 0 : 4096);
+}
+
+// Runs the show in 1 ms steps, checking the tracks at every frame
+static void run(Adafruit_PWMShow &show, uint32_t start, uint32_t ms) {
+  for (uint32_t step = 0; step <= ms; step++) {
+    host_micros = start + step * 1000;
+    CHECK(show.poll());
+    uint32_t t_ms = (step % 4000) / 20 * 20; // last frame played
+    if (step % 20 == 0 && show.playing())
+      check_tracks(t_ms);
+  }
+}
+
+int main() {
+  Adafruit_PWMServoDriver a(0x40), b(0x41);
+  a.begin();
+  b.begin();
+  Adafruit_PWMServoDriver *chips[2] = {&a, &b};
+  Adafruit_PWMShow show(chips, 2);
+  host_regs[0x40][PCA9685_LED0_ON_L + 8] = 0xAA; // channel 2, no track
+
+  // Once: 101 frames with writes, then 2 s of empty frames
+  CHECK(show.begin(example_show, example_show_len));
+  host_micros = 1000000;
+  show.play();
+  run(show, 1000000, 3999);
+  CHECK(show.playing());
+  host_micros = 1000000 + 4000000;
+  CHECK(show.poll());
+  CHECK(!show.playing());
+  CHECK_EQ(show.frame(), 101 + (2000000 + 0xFFFE) / 0xFFFF);
+  CHECK_EQ(show.errors(), 0);
+  CHECK_EQ(host_regs[0x40][PCA9685_LED0_ON_L + 8], 0xAA);
+
+  // Looped: the second pass starts over at frame 0
+  host_micros = 6000000;
+  show.play(true);
+  run(show, 6000000, 8600);
+  CHECK(show.playing());
+  check_tracks(600);
+  CHECK_EQ(show.errors(), 0);
+
+  // A looped show without any delay plays one pass per poll()
+  static const uint8_t instant[] = {'P', 'S', PWM_SHOW_VERSION, 0,
+                                    0, 0, 1, 0x40, PCA9685_LED0_ON_L + 20, 4,
+                                    0, 0, 100, 0};
+  CHECK(show.begin(instant, sizeof(instant)));
+  show.play(true);
+  CHECK(show.poll());
+  CHECK_EQ(show.frame(), 1);
+  CHECK(show.poll());
+  CHECK_EQ(show.frame(), 2);
+  CHECK_EQ(off_ticks(0x40, 5), 100);
+
+  // Writes past LED15, past ALL_LED, larger than the 32 byte bus buffer
+  // or for another chip are skipped
+  static uint8_t bad[128];
+  uint8_t n = 0;
+  bad[n++] = 'P';
+  bad[n++] = 'S';
+  bad[n++] = PWM_SHOW_VERSION;
+  bad[n++] = 0;
+  bad[n++] = 0;
+  bad[n++] = 0;
+  bad[n++] = 5;
+  static const uint8_t writes[5][2] = {
+      {0x40, PCA9685_LED0_ON_L + 60}, // 8 bytes: LED15 and 4 beyond
+      {0x40, PCA9685_ALLLED_ON_L},    // 8 bytes: ALL_LED and PRESCALE
+      {0x40, PCA9685_LED0_ON_L},      // 32 bytes and the register byte
+      {0x42, PCA9685_LED0_ON_L},      // not in the chain
+      {0x40, PCA9685_LED0_ON_L + 60}, // 4 bytes, valid
+  };
+  static const uint8_t lens[5] = {8, 8, 32, 4, 4};
+  for (uint8_t w = 0; w < 5; w++) {
+    bad[n++] = writes[w][0];
+    bad[n++] = writes[w][1];
+    bad[n++] = lens[w];
+    for (uint8_t i = 0; i < lens[w]; i++)
+      bad[n++] = 0x11;
+  }
+  uint8_t prescale = host_regs[0x40][PCA9685_PRESCALE];
+  uint16_t led0 = off_ticks(0x40, 0);
+  uint32_t writes_before = host_writes;
+  CHECK(show.begin(bad, n));
+  show.play();
+  CHECK(show.poll());
+  CHECK(!show.playing());
+  CHECK_EQ(show.errors(), 4);
+  CHECK_EQ(host_writes, writes_before + 1);
+  CHECK_EQ(off_ticks(0x40, 15), 0x1111);
+  CHECK_EQ(host_regs[0x40][PCA9685_PRESCALE], prescale);
+  CHECK_EQ(off_ticks(0x40, 0), led0);
+  return HOST_TEST_END();
+}
@@ -0,0 +1,114 @@
+/*!
+ *  @file test_timing.cpp
+ *
+ *  Adafruit_PWMTiming predictions of direct writes and of writes queued on
+ *  an Adafruit_PWMBus: queued channels have no prediction until the bus
+ *  sends them, then all writes of one transfer latch at its single STOP,
+ *  including when a full queue is sent early.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Adafruit_PWMTiming.h"
+#include "host_test.h"
+
+#define NS_PER_BYTE 22500
+#define OVERHEAD_US 20
+
+static uint32_t transfers;
+
+static bool count_transfer(void *context, const pwm_bus_msg_t *msgs,
+                           uint8_t count) {
+  (void)context;
+  (void)msgs;
+  (void)count;
+  transfers++;
+  return true;
+}
+
+// Predicted STOP of a transfer of 'bytes' started at 'started'
+static uint32_t stop_at(uint32_t started, uint32_t bytes) {
+  return started + OVERHEAD_US + bytes * NS_PER_BYTE / 1000;
+}
+
+int main() {
+  Adafruit_PWMServoDriver a(0x40), b(0x41);
+  a.begin();
+  b.begin();
+  a.setPWMFreq(50);
+  b.setPWMFreq(50);
+  Adafruit_PWMTiming ta, tb;
+  ta.attach(a);
+  tb.attach(b);
+  uint32_t period = ta.periodMicros();
+  CHECK(period > 19000 && period < 21000);
+
+  // Direct write: address byte and 5 register bytes, then half a period
+  // without a phase reference
+  host_micros = 1000;
+  a.setPWM(0, 0, 300);
+  CHECK_EQ(a.predictOutputTime(0), stop_at(1000, 6) + period / 2);
+
+  // With a reference, the next period start after the STOP
+  ta.setPhaseReference(500);
+  tb.setPhaseReference(500);
+  CHECK_EQ(a.predictOutputTime(0), 500 + period);
+
+  // Queued writes of two chips: nothing predicted until the flush, then
+  // every channel latches at the end of the one transfer
+  static uint8_t pool[64];
+  static pwm_bus_msg_t msgs[4];
+  Adafruit_PWMBus bus(pool, sizeof(pool), msgs, 4);
+  bus.setTransfer(count_transfer, NULL);
+  bus.attach(a);
+  bus.attach(b);
+  host_micros = 2000;
+  a.setPWM(1, 0, 400);
+  uint16_t on[2] = {0, 0}, off[2] = {500, 600};
+  b.setPWMBurst(2, 2, on, off);
+  CHECK_EQ(a.predictOutputTime(1), 0);
+  CHECK_EQ(b.predictOutputTime(2), 0);
+  CHECK_EQ(a.predictOutputTime(0), 500 + period); // sent before, unchanged
+
+  // A whole frame later, the prediction follows the flush
+  host_micros = 2000 + period - 100;
+  uint32_t flushed = host_micros;
+  CHECK(bus.flush());
+  CHECK_EQ(transfers, 1);
+  uint32_t stop = stop_at(flushed, 6 + 10);
+  int32_t into = (int32_t)(stop - 500) % (int32_t)period;
+  uint32_t expected = stop + (period - into);
+  CHECK(expected > flushed);
+  CHECK_EQ(a.predictOutputTime(1), expected);
+  CHECK_EQ(b.predictOutputTime(2), expected);
+  CHECK_EQ(b.predictOutputTime(3), expected);
+
+  // A full queue is sent early: those writes latch at the early transfer,
+  // the rest at the flush
+  ta.setPhaseReference(0);
+  host_micros = 100000;
+  for (uint8_t num = 4; num < 9; num++) {
+    a.setPWM(num, 0, 100 * num);
+    host_micros += 10;
+  }
+  CHECK_EQ(transfers, 2); // 4 messages, sent at the fifth write
+  host_micros = 110000;
+  CHECK(bus.flush());
+  CHECK_EQ(transfers, 3);
+  uint32_t early = stop_at(100040, 4 * 6);
+  uint32_t late = stop_at(110000, 6);
+  CHECK_EQ(a.predictOutputTime(4), early + (period - early % period));
+  CHECK_EQ(a.predictOutputTime(7), early + (period - early % period));
+  CHECK_EQ(a.predictOutputTime(8), late + (period - late % period));
+
+  // Without a transfer function each write is its own transfer
+  bus.setTransfer(NULL, NULL);
+  host_micros = 120000;
+  a.setPWM(9, 0, 100);
+  a.setPWM(10, 0, 100);
+  CHECK(bus.flush());
+  CHECK_EQ(a.predictOutputTime(9), stop_at(120000, 6) +
+                                       (period - stop_at(120000, 6) % period));
+  CHECK_EQ(a.predictOutputTime(10), a.predictOutputTime(9));
+  return HOST_TEST_END();
+}
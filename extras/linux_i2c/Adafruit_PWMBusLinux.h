@@ -0,0 +1,67 @@
+/*!
+ *  @file Adafruit_PWMBusLinux.h
+ *
+ *  Adafruit_PWMBus transfer function for Linux i2c-dev: the queued writes of
+ *  every chip on the bus go out as the messages of a single I2C_RDWR ioctl,
+ *  split only at the adapter's I2C_RDWR_IOCTL_MAX_MSGS limit. For builds of
+ *  the library on Linux hosts (e.g. with a Wire/BusIO port), not compiled
+ *  by the Arduino IDE.
+ *
+ *    int fd = open("/dev/i2c-1", O_RDWR);
+ *    pwm_linux_i2c_t linux_bus = {fd, NULL};
+ *    bus.setTransfer(pwm_linux_i2c_transfer, &linux_bus,
+ *                    I2C_RDWR_IOCTL_MAX_MSGS);
+ *
+ *  Set 'ioctl' to a function of your own to check the message layout
+ *  without an adapter, as extras/host_test/test_bus_linux.cpp does.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMBusLinux_H
+#define _ADAFRUIT_PWMBusLinux_H
+
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
+
+#include "Adafruit_PWMBus.h"
+
+/*!
+ *  @brief  One i2c-dev adapter
+ */
+typedef struct {
+  int fd; ///< Open /dev/i2c-N
+  /** ioctl() replacement, NULL for the real one */
+  int (*ioctl)(int fd, unsigned long request, void *arg);
+} pwm_linux_i2c_t;
+
+/*!
+ *  @brief  Sends queued writes as one I2C_RDWR transaction
+ *  @param  context The pwm_linux_i2c_t of the adapter
+ *  @param  msgs Writes to send, in order
+ *  @param  count Number of writes, at most I2C_RDWR_IOCTL_MAX_MSGS
+ *  @return true if the adapter accepted every message
+ */
+static inline bool pwm_linux_i2c_transfer(void *context,
+                                          const pwm_bus_msg_t *msgs,
+                                          uint8_t count) {
+  pwm_linux_i2c_t *bus = (pwm_linux_i2c_t *)context;
+  struct i2c_msg m[I2C_RDWR_IOCTL_MAX_MSGS];
+  struct i2c_rdwr_ioctl_data data;
+
+  if (count > I2C_RDWR_IOCTL_MAX_MSGS)
+    return false;
+  for (uint8_t i = 0; i < count; i++) {
+    m[i].addr = msgs[i].addr;
+    m[i].flags = 0; // write, 7 bit address
+    m[i].len = msgs[i].len;
+    m[i].buf = (__u8 *)msgs[i].buf;
+  }
+  data.msgs = m;
+  data.nmsgs = count;
+  if (bus->ioctl)
+    return bus->ioctl(bus->fd, I2C_RDWR, &data) >= 0;
+  return ioctl(bus->fd, I2C_RDWR, &data) >= 0;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*!
+ *  @file Adafruit_PWMCompletionsLinux.h
+ *
+ *  eventfd notification for Adafruit_PWMCompletions, so completions of any
+ *  number of drivers wake a single epoll loop:
+ *
+ *    int efd = pwm_eventfd_open();
+ *    completions.setNotify(pwm_eventfd_notify, &efd);
+ *    // add efd to the epoll set for EPOLLIN, then when it fires:
+ *    pwm_eventfd_ack(efd);
+ *    completions.processCompletions();
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _ADAFRUIT_PWMCompletionsLinux_H
+#define _ADAFRUIT_PWMCompletionsLinux_H
+
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "Adafruit_PWMCompletions.h"
+
+/*!
+ *  @brief  Creates a non-blocking eventfd for completion notifications
+ *  @return the file descriptor, -1 on error
+ */
+static inline int pwm_eventfd_open() {
+  return eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+/*!
+ *  @brief  Notify function for Adafruit_PWMCompletions::setNotify()
+ *  @param  context Pointer to the eventfd
+ */
+static inline void pwm_eventfd_notify(void *context) {
+  uint64_t one = 1;
+  // Only fails when the counter is saturated, the fd is readable anyway
+  (void)!write(*(int *)context, &one, sizeof(one));
+}
+
+/*!
+ *  @brief  Clears the eventfd before processing the completions
+ *  @param  fd The eventfd
+ */
+static inline void pwm_eventfd_ack(int fd) {
+  uint64_t count;
+  (void)!read(fd, &count, sizeof(count));
+}
+
+#endif
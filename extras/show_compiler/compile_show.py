@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""Compile a PCA9685 show timeline into pre-planned I2C writes.
+
+The show is a JSON file of keyframed channel tracks. Every frame is sampled,
+converted to ON/OFF ticks, diffed against the previous frame and planned into
+as few LED register writes as possible, so that Adafruit_PWMShow on the
+microcontroller only has to wait and send bytes:
+
+    extras/show_compiler/compile_show.py show.json -o show.h
+    extras/show_compiler/compile_show.py show.json -o show.bin --format bin
+
+Show file:
+
+    {
+      "fps": 50,                    frames per second
+      "oscillator": 25000000,       oscillator frequency, for "us" tracks
+      "prescale": 121,              prescale the chips are set to (50 Hz)
+      "tracks": [
+        {"chip": 64, "channel": 0, "unit": "us",
+         "keys": [[0, 1000], [2000, 2000]]},
+        {"chip": 64, "channel": 4, "unit": "pin", "interp": "step",
+         "keys": [[0, 0], [500, 4095]]}
+      ]
+    }
+
+Keys are [time in ms, value], values are interpolated linearly unless
+"interp" is "step". Units: "us" pulse length in microseconds, "ticks" OFF
+tick with ON at 0, "pin" setPin() value where 0 is fully off and 4095 fully
+on. Channels without a track are never written. The show lasts until the
+last key unless "duration_ms" is given.
+
+Output format, all numbers little endian: 'P', 'S', version 1, flags 0, then
+per frame the delay after the previous frame in microseconds (16 bit), the
+number of writes (8 bit) and each write as chip address, first register,
+payload length and payload. Frames without changes are folded into the delay
+of the next frame, and empty frames pad the show to its end, at least one
+frame period, so a looped show never repeats without a delay. Keep in sync
+with Adafruit_PWMShow.cpp.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+VERSION = 1
+LED0_ON_L = 0x06
+ALLLED_ON_L = 0xFA
+NUM_CHANNELS = 16
+MAX_DELAY_US = 0xFFFF
+# Clean channels between two dirty runs that are cheaper to resend than to
+# start a new write for (as PCA9685_FRAME_MERGE_GAP in the library)
+MERGE_GAP = 1
+
+
+def pin_to_pwm(val):
+    """setPin() semantics: ON and OFF ticks of a 0..4095 value."""
+    val = max(0, min(4095, int(round(val))))
+    if val == 4095:
+        return (4096, 0)
+    if val == 0:
+        return (0, 4096)
+    return (0, val)
+
+
+class Track:
+    """One keyframed channel."""
+
+    def __init__(self, spec, show):
+        self.chip = int(spec["chip"])
+        self.channel = int(spec["channel"])
+        if not 0 <= self.channel < NUM_CHANNELS:
+            raise ValueError("channel %d out of range" % self.channel)
+        self.unit = spec.get("unit", "ticks")
+        self.step = spec.get("interp", "linear") == "step"
+        self.keys = sorted((float(t), float(v)) for t, v in spec["keys"])
+        if not self.keys:
+            raise ValueError("track without keys")
+        if self.unit == "us":
+            rate = show["oscillator"] / (show["prescale"] + 1)
+            self.ticks_per_us = rate / 1e6
+        elif self.unit not in ("ticks", "pin"):
+            raise ValueError("unknown unit %r" % self.unit)
+
+    def value(self, t_ms):
+        keys = self.keys
+        if t_ms <= keys[0][0]:
+            return keys[0][1]
+        for (t0, v0), (t1, v1) in zip(keys, keys[1:]):
+            if t_ms < t1:
+                if self.step or t1 == t0:
+                    return v0
+                return v0 + (v1 - v0) * (t_ms - t0) / (t1 - t0)
+        return keys[-1][1]
+
+    def output(self, t_ms):
+        """ON and OFF ticks at a time."""
+        v = self.value(t_ms)
+        if self.unit == "pin":
+            return pin_to_pwm(v)
+        if self.unit == "us":
+            v = v * self.ticks_per_us
+        return (0, max(0, min(4095, int(round(v)))))
+
+
+def encode(outputs):
+    return b"".join(struct.pack("<HH", on, off) for on, off in outputs)
+
+
+def plan_chip(new, old, controlled, max_payload):
+    """Writes (register, payload) bringing one chip from 'old' to 'new'."""
+    dirty = [n for n in range(NUM_CHANNELS)
+             if n in controlled and new.get(n) != old.get(n)]
+    if not dirty:
+        return []
+
+    # One ALL_LED write if every channel ends up the same
+    if len(controlled) == NUM_CHANNELS and len(set(new.values())) == 1:
+        return [(ALLLED_ON_L, encode([new[0]]))]
+
+    # Runs of dirty channels, merged across short gaps of channels whose
+    # content is known
+    runs = []
+    for n in dirty:
+        if runs:
+            first, last = runs[-1]
+            gap = range(last + 1, n)
+            if len(gap) <= MERGE_GAP and all(g in controlled and g in old
+                                             for g in gap):
+                runs[-1] = (first, n)
+                continue
+        runs.append((n, n))
+
+    writes = []
+    per_write = max(1, max_payload // 4)
+    for first, last in runs:
+        for start in range(first, last + 1, per_write):
+            end = min(last, start + per_write - 1)
+            payload = encode([new[n] for n in range(start, end + 1)])
+            writes.append((LED0_ON_L + 4 * start, payload))
+    return writes
+
+
+def compile_show(show, max_payload):
+    tracks = [Track(spec, show) for spec in show["tracks"]]
+    fps = float(show.get("fps", 50))
+    end_ms = show.get("duration_ms",
+                      max(t.keys[-1][0] for t in tracks) if tracks else 0)
+    chips = sorted(set(t.chip for t in tracks))
+    controlled = {c: set(t.channel for t in tracks if t.chip == c)
+                  for c in chips}
+    state = {c: {} for c in chips}
+
+    out = bytearray(b"PS" + bytes([VERSION, 0]))
+    stats = {"frames": 0, "writes": 0, "channels": 0}
+    last_us = 0
+    frame = 0
+    while True:
+        t_us = int(round(frame * 1e6 / fps))
+        if t_us > end_ms * 1000:
+            break
+        new = {c: {} for c in chips}
+        for t in tracks:
+            new[t.chip][t.channel] = t.output(t_us / 1000.0)
+        writes = []
+        for c in chips:
+            for reg, payload in plan_chip(new[c], state[c], controlled[c],
+                                          max_payload):
+                writes.append((c, reg, payload))
+            state[c] = new[c]
+        frame += 1
+        if not writes:
+            continue
+
+        # Long pauses become empty frames
+        delay = t_us - last_us
+        while delay > MAX_DELAY_US:
+            out += struct.pack("<HB", MAX_DELAY_US, 0)
+            delay -= MAX_DELAY_US
+        last_us = t_us
+        for i in range(0, len(writes), 255):
+            chunk = writes[i:i + 255]
+            out += struct.pack("<HB", delay if i == 0 else 0, len(chunk))
+            for c, reg, payload in chunk:
+                out += struct.pack("<BBB", c, reg, len(payload)) + payload
+                stats["channels"] += len(payload) // 4
+        stats["frames"] += 1
+        stats["writes"] += len(writes)
+
+    # Empty frames up to the end, so a looped show keeps its length; a
+    # static show still lasts a frame period
+    delay = max(int(round(end_ms * 1000)), int(round(1e6 / fps))) - last_us
+    while delay > 0:
+        out += struct.pack("<HB", min(delay, MAX_DELAY_US), 0)
+        delay -= MAX_DELAY_US
+    return bytes(out), stats
+
+
+def as_header(data, name):
+    lines = ["// Generated by extras/show_compiler/compile_show.py",
+             "#include <Arduino.h>", "",
+             "const uint32_t %s_len = %d;" % (name, len(data)),
+             "const uint8_t %s[] PROGMEM = {" % name]
+    for i in range(0, len(data), 12):
+        lines.append("    " + ", ".join("0x%02X" % b
+                                        for b in data[i:i + 12]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("show", help="show timeline, JSON")
+    parser.add_argument("-o", "--output", help="output file, default stdout")
+    parser.add_argument("--format", choices=("header", "bin"),
+                        default="header",
+                        help="C header with a PROGMEM array, or raw bytes")
+    parser.add_argument("--name", default="show",
+                        help="array name in the header")
+    parser.add_argument("--max-payload", type=int, default=28,
+                        help="register bytes per write, 28 fits the 32 byte "
+                        "Wire buffer; the player skips writes larger than "
+                        "its bus buffer")
+    args = parser.parse_args()
+    if not 4 <= args.max_payload <= 64:
+        parser.error("--max-payload must be 4 to 64")
+
+    with open(args.show) as f:
+        show = json.load(f)
+    data, stats = compile_show(show, args.max_payload)
+
+    if args.format == "bin":
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(data)
+        else:
+            sys.stdout.buffer.write(data)
+    else:
+        text = as_header(data, args.name)
+        if args.output:
+            with open(args.output, "w") as f:
+                f.write(text)
+        else:
+            sys.stdout.write(text)
+
+    sys.stderr.write("%d bytes, %d frames, %d writes, %d channel updates\n"
+                     % (len(data), stats["frames"], stats["writes"],
+                        stats["channels"]))
+
+
+if __name__ == "__main__":
+    main()
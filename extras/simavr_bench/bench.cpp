@@ -0,0 +1,89 @@
+/*!
+ *  @file bench.cpp
+ *
+ *  AVR benchmark firmware for the PCA9685 driver hot paths, run under
+ *  simavr by harness.c. Every measured call is bracketed by writes to the
+ *  marker register, the harness turns them into cycle counts.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "Adafruit_PWMFrame.h"
+#include "Adafruit_PWMServoDriver.h"
+#include "bench.h"
+
+#define MARK(v) (*(volatile uint8_t *)BENCH_MARKER_ADDR = (v))
+
+// Keeps the compiler from dropping results of calls without side effects
+static volatile uint16_t sink;
+
+int main(void) {
+  Adafruit_PWMServoDriver pwm(BENCH_ADDRESS);
+  Adafruit_PWMFrame frame(pwm);
+  uint16_t on[PCA9685_NUM_CHANNELS];
+  uint16_t off[PCA9685_NUM_CHANNELS];
+  uint16_t us[PCA9685_NUM_CHANNELS];
+
+  pwm.begin();
+  pwm.setPWMFreq(50);
+  for (uint8_t i = 0; i < PCA9685_NUM_CHANNELS; i++) {
+    on[i] = 0;
+    off[i] = 205 + 20 * i;
+    us[i] = 1000 + 60 * i;
+    frame.setPWM(i, on[i], off[i]);
+  }
+  // Send the whole image once, so the measured flushes are the steady state
+  frame.invalidate();
+  frame.flush();
+
+  for (uint8_t r = 0; r < BENCH_REPEAT; r++) {
+    uint8_t ch = r & 15;
+
+    MARK(1);
+    MARK(BENCH_END);
+
+    MARK(2);
+    pwm.setPWM(ch, 0, 2048 + r);
+    MARK(BENCH_END);
+
+    MARK(3);
+    pwm.setPin(ch, 1024 + r);
+    MARK(BENCH_END);
+
+    MARK(4);
+    pwm.writeMicroseconds(ch, 1500 + r);
+    MARK(BENCH_END);
+
+    MARK(5);
+    sink = pwm.microsecondsToTicks(1500 + r);
+    MARK(BENCH_END);
+
+    off[0] = 205 + r;
+    MARK(6);
+    pwm.setPWMBurst(0, PCA9685_NUM_CHANNELS, on, off);
+    MARK(BENCH_END);
+
+    us[0] = 1000 + r;
+    MARK(7);
+    pwm.writeMicrosecondsBatch(0, PCA9685_NUM_CHANNELS, us);
+    MARK(BENCH_END);
+
+    for (uint8_t i = 0; i < 4; i++)
+      frame.setPin(4 * i, 100 * r + i);
+    MARK(8);
+    frame.flush();
+    MARK(BENCH_END);
+
+    MARK(9);
+    sink = pwm.getPWM(ch, true);
+    MARK(BENCH_END);
+  }
+
+  // Sleeping with interrupts off ends the simulation
+  cli();
+  sleep_mode();
+  return 0;
+}
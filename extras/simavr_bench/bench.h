@@ -0,0 +1,34 @@
+/*!
+ *  @file bench.h
+ *
+ *  Benchmark IDs and the marker register shared by the AVR benchmark
+ *  firmware and the simavr harness. The firmware writes a benchmark ID to
+ *  the marker register before the measured call and BENCH_END after it; the
+ *  harness timestamps both writes in CPU cycles.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _BENCH_H
+#define _BENCH_H
+
+/** GPIOR0 data space address on the ATmega48/88/168/328 */
+#define BENCH_MARKER_ADDR 0x3E
+#define BENCH_END 0x00    /**< Marker written after a measured call */
+#define BENCH_REPEAT 8    /**< Measured calls per benchmark */
+#define BENCH_ADDRESS 0x40 /**< 7 bit address of the simulated PCA9685 */
+
+/** Benchmarks in the order the firmware runs them */
+#define BENCH_LIST(X)                                                          \
+  X(1, "marker overhead")                                                      \
+  X(2, "setPWM")                                                               \
+  X(3, "setPin")                                                               \
+  X(4, "writeMicroseconds")                                                    \
+  X(5, "microsecondsToTicks")                                                  \
+  X(6, "setPWMBurst x16")                                                      \
+  X(7, "writeMicrosecondsBatch x16")                                           \
+  X(8, "frame flush 4 channels")                                               \
+  X(9, "getPWM")
+
+#define BENCH_COUNT 10 /**< One past the highest benchmark ID */
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ *  harness.c
+ *
+ *  Runs the benchmark firmware under simavr with a PCA9685 model on the
+ *  TWI bus and prints cycles per call for each benchmark, together with
+ *  the cycles the bus was busy and the bytes it carried.
+ *
+ *    harness bench.elf [mcu] [f_cpu] [i2c_hz]
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avr_twi.h>
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_io.h>
+
+#include "bench.h"
+
+/* Simulated PCA9685: register pointer with auto-increment */
+typedef struct {
+  avr_irq_t *irq;
+  uint8_t regs[256];
+  uint8_t ptr;
+  int selected;
+  int have_ptr;
+  avr_cycle_count_t start; /* START of the current transaction */
+  avr_cycle_count_t busy;  /* cycles between START and STOP, total */
+  unsigned long bytes;     /* address and data bytes, total */
+} pca9685_t;
+
+typedef struct {
+  const char *name;
+  unsigned long calls;
+  avr_cycle_count_t cycles;
+  avr_cycle_count_t busy;
+  unsigned long bytes;
+} bench_t;
+
+static avr_t *avr;
+static pca9685_t chip;
+static bench_t benches[BENCH_COUNT];
+static int current = BENCH_END;
+static avr_cycle_count_t mark_cycle, mark_busy;
+static unsigned long mark_bytes;
+
+static void pca9685_next(pca9685_t *p) {
+  /* MODE1.AI */
+  if (p->regs[0] & 0x20)
+    p->ptr++;
+}
+
+static void pca9685_in_hook(avr_irq_t *irq, uint32_t value, void *param) {
+  pca9685_t *p = (pca9685_t *)param;
+  avr_twi_msg_irq_t v;
+  (void)irq;
+  v.u.v = value;
+
+  if (v.u.twi.msg & TWI_COND_STOP) {
+    if (p->selected)
+      p->busy += avr->cycle - p->start;
+    p->selected = 0;
+  }
+  if (v.u.twi.msg & TWI_COND_START) {
+    /* A repeated start continues the same transaction */
+    if (!p->selected)
+      p->start = avr->cycle;
+    p->selected = 0;
+    if ((v.u.twi.addr >> 1) == BENCH_ADDRESS) {
+      p->selected = v.u.twi.addr;
+      p->have_ptr = p->have_ptr && (v.u.twi.addr & 1);
+      p->bytes++;
+      avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+                    avr_twi_irq_msg(TWI_COND_ACK, p->selected, 1));
+    }
+  }
+  if (!p->selected)
+    return;
+  if (v.u.twi.msg & TWI_COND_WRITE) {
+    avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_ACK, p->selected, 1));
+    p->bytes++;
+    if (!p->have_ptr) {
+      p->ptr = v.u.twi.data;
+      p->have_ptr = 1;
+    } else {
+      p->regs[p->ptr] = v.u.twi.data;
+      pca9685_next(p);
+    }
+  }
+  if (v.u.twi.msg & TWI_COND_READ) {
+    p->bytes++;
+    avr_raise_irq(p->irq + TWI_IRQ_INPUT,
+                  avr_twi_irq_msg(TWI_COND_READ, p->selected,
+                                  p->regs[p->ptr]));
+    pca9685_next(p);
+  }
+}
+
+static void pca9685_init(pca9685_t *p) {
+  static const char *names[2] = {"8>pca9685.out", "32<pca9685.in"};
+  memset(p, 0, sizeof(*p));
+  p->regs[0x00] = 0x11; /* MODE1 after power up */
+  p->regs[0x01] = 0x04; /* MODE2 */
+  p->regs[0xFE] = 0x1E; /* PRESCALE, 200 Hz */
+  p->irq = avr_alloc_irq(&avr->irq_pool, 0, 2, names);
+  avr_irq_register_notify(p->irq + TWI_IRQ_OUTPUT, pca9685_in_hook, p);
+  avr_connect_irq(p->irq + TWI_IRQ_INPUT,
+                  avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+  avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT),
+                  p->irq + TWI_IRQ_OUTPUT);
+}
+
+/* The firmware wrote the marker register */
+static void marker_write(avr_t *a, avr_io_addr_t addr, uint8_t v,
+                         void *param) {
+  (void)addr;
+  (void)param;
+  if (v != BENCH_END) {
+    current = v < BENCH_COUNT ? v : BENCH_END;
+    mark_cycle = a->cycle;
+    mark_busy = chip.busy;
+    mark_bytes = chip.bytes;
+    return;
+  }
+  if (current == BENCH_END)
+    return;
+  bench_t *b = &benches[current];
+  b->calls++;
+  b->cycles += a->cycle - mark_cycle;
+  b->busy += chip.busy - mark_busy;
+  b->bytes += chip.bytes - mark_bytes;
+  current = BENCH_END;
+}
+
+int main(int argc, char *argv[]) {
+  elf_firmware_t f;
+  const char *mcu = argc > 2 ? argv[2] : "atmega328p";
+  unsigned long f_cpu = argc > 3 ? strtoul(argv[3], NULL, 0) : 16000000UL;
+  unsigned long i2c_hz = argc > 4 ? strtoul(argv[4], NULL, 0) : 400000UL;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s bench.elf [mcu] [f_cpu] [i2c_hz]\n", argv[0]);
+    return 1;
+  }
+  memset(&f, 0, sizeof(f));
+  if (elf_read_firmware(argv[1], &f)) {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  strncpy(f.mmcu, mcu, sizeof(f.mmcu) - 1);
+  f.frequency = f_cpu;
+
+  avr = avr_make_mcu_by_name(f.mmcu);
+  if (!avr) {
+    fprintf(stderr, "%s: unknown mcu %s\n", argv[0], f.mmcu);
+    return 1;
+  }
+  avr_init(avr);
+  avr_load_firmware(avr, &f);
+  pca9685_init(&chip);
+  avr_register_io_write(avr, BENCH_MARKER_ADDR, marker_write, NULL);
+
+#define BENCH_NAME(id, label) benches[id].name = label;
+  BENCH_LIST(BENCH_NAME)
+
+  int state = cpu_Running;
+  while (state != cpu_Done && state != cpu_Crashed)
+    state = avr_run(avr);
+  if (state == cpu_Crashed) {
+    fprintf(stderr, "%s: firmware crashed\n", argv[0]);
+    return 1;
+  }
+
+  /* Wire time: 9 SCL periods per byte plus start and stop */
+  printf("%s at %lu Hz, I2C at %lu Hz, cycles per call\n", mcu, f_cpu, i2c_hz);
+  printf("%-28s %10s %10s %8s %10s\n", "benchmark", "cycles", "bus", "bytes",
+         "wire us");
+  for (int i = 0; i < BENCH_COUNT; i++) {
+    bench_t *b = &benches[i];
+    if (!b->name || !b->calls)
+      continue;
+    double bytes = (double)b->bytes / b->calls;
+    printf("%-28s %10.0f %10.0f %8.1f %10.1f\n", b->name,
+           (double)b->cycles / b->calls, (double)b->busy / b->calls, bytes,
+           (bytes * 9 + 2) * 1e6 / i2c_hz * (bytes > 0));
+  }
+  return 0;
+}
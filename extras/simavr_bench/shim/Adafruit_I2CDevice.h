@@ -0,0 +1,43 @@
+/*!
+ *  @file Adafruit_I2CDevice.h
+ *
+ *  Polled TWI master with the subset of the Adafruit BusIO I2C device API
+ *  the driver uses. Transfers are limited to 32 bytes like the AVR Wire
+ *  library, so the driver splits bursts the same way it does on an Uno.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _BENCH_I2CDEVICE_H
+#define _BENCH_I2CDEVICE_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+#ifndef BENCH_I2C_HZ
+#define BENCH_I2C_HZ 400000 /**< SCL frequency */
+#endif
+
+/*!
+ *  @brief  One device on the TWI bus
+ */
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire = &Wire);
+  bool begin(bool addr_detect = true);
+  bool write(const uint8_t *buffer, size_t len, bool stop = true,
+             const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       bool stop = false);
+
+  /*!
+   *  @brief  Largest transfer, as with the AVR Wire library
+   *  @return bytes per transfer
+   */
+  size_t maxBufferSize() { return 32; }
+
+private:
+  uint8_t _addr;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*!
+ *  @file Arduino.h
+ *
+ *  Minimal stand-in for the Arduino AVR core, just what the driver needs,
+ *  so the benchmark firmware builds with plain avr-gcc and the timing is
+ *  not disturbed by core interrupts (no timer 0 tick).
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _BENCH_ARDUINO_H
+#define _BENCH_ARDUINO_H
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Same macros as the Arduino AVR core
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define interrupts() sei()
+#define noInterrupts() cli()
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Timer 1 free running at F_CPU / 64 and polled for overflows, no
+// interrupt; at 16 MHz calls must come at least every 262 ms
+unsigned long millis(void);
+unsigned long micros(void);
+
+/*!
+ *  @brief  Byte sink, as in the Arduino core, with the few print overloads
+ * the driver reports use
+ */
+class Print {
+public:
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--)
+      n += write(*buffer++);
+    return n;
+  }
+  size_t print(const char *str) {
+    return write((const uint8_t *)str, strlen(str));
+  }
+  size_t print(unsigned long n) {
+    char buf[11];
+    return print(ultoa(n, buf, 10));
+  }
+  size_t println(const char *str) { return print(str) + print("\r\n"); }
+  size_t println(unsigned long n) { return print(n) + print("\r\n"); }
+};
+
+/*!
+ *  @brief  Byte source, as in the Arduino core
+ */
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+#endif
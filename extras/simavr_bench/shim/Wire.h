@@ -0,0 +1,19 @@
+/*!
+ *  @file Wire.h
+ *
+ *  Placeholder TwoWire type, the benchmark drives the TWI directly from
+ *  the Adafruit_I2CDevice shim.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+#ifndef _BENCH_WIRE_H
+#define _BENCH_WIRE_H
+
+/*!
+ *  @brief  Empty bus handle
+ */
+class TwoWire {};
+
+extern TwoWire Wire;
+
+#endif
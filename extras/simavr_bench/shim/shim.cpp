@@ -0,0 +1,128 @@
+/*!
+ *  @file shim.cpp
+ *
+ *  Runtime pieces of the benchmark shim: busy wait delays, a polled
+ *  microsecond clock, heap operators and the polled TWI master.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <util/twi.h>
+
+#include "Adafruit_I2CDevice.h"
+
+TwoWire Wire;
+
+void delay(unsigned long ms) {
+  while (ms--)
+    _delay_ms(1);
+}
+
+void delayMicroseconds(unsigned int us) {
+  while (us--)
+    _delay_us(1);
+}
+
+unsigned long micros(void) {
+  static uint16_t overflows;
+  uint8_t sreg = SREG;
+  cli();
+  if (!TCCR1B)
+    TCCR1B = _BV(CS11) | _BV(CS10); // normal mode, F_CPU / 64
+  if (TIFR1 & _BV(TOV1)) {
+    TIFR1 = _BV(TOV1);
+    overflows++;
+  }
+  uint16_t count = TCNT1;
+  // Overflow between the flag test and the counter read
+  if ((TIFR1 & _BV(TOV1)) && count < 0x8000) {
+    TIFR1 = _BV(TOV1);
+    overflows++;
+  }
+  SREG = sreg;
+  return (((uint32_t)overflows << 16) | count) * (64 / (F_CPU / 1000000UL));
+}
+
+unsigned long millis(void) { return micros() / 1000; }
+
+void *operator new(size_t size) { return malloc(size); }
+void operator delete(void *ptr) { free(ptr); }
+void operator delete(void *ptr, size_t) { free(ptr); }
+extern "C" void __cxa_pure_virtual(void) { abort(); }
+
+static uint8_t twi_command(uint8_t bits) {
+  TWCR = _BV(TWINT) | _BV(TWEN) | bits;
+  while (!(TWCR & _BV(TWINT)))
+    ;
+  return TW_STATUS;
+}
+
+static void twi_stop(void) {
+  TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+  while (TWCR & _BV(TWSTO))
+    ;
+}
+
+static bool twi_start(uint8_t sla) {
+  uint8_t status = twi_command(_BV(TWSTA));
+  if (status != TW_START && status != TW_REP_START)
+    return false;
+  TWDR = sla;
+  status = twi_command(0);
+  return status == TW_MT_SLA_ACK || status == TW_MR_SLA_ACK;
+}
+
+static bool twi_send(const uint8_t *buffer, size_t len) {
+  while (len--) {
+    TWDR = *buffer++;
+    if (twi_command(0) != TW_MT_DATA_ACK)
+      return false;
+  }
+  return true;
+}
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire)
+    : _addr(addr) {
+  (void)theWire;
+}
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  (void)addr_detect;
+  TWSR = 0; // prescaler 1
+  TWBR = ((F_CPU / BENCH_I2C_HZ) - 16) / 2;
+  TWCR = _BV(TWEN);
+  return true;
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  if (prefix_len + len > maxBufferSize())
+    return false;
+  bool ok = twi_start(_addr << 1) && twi_send(prefix_buffer, prefix_len) &&
+            twi_send(buffer, len);
+  if (stop || !ok)
+    twi_stop();
+  return ok;
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len,
+                                         uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  (void)stop;
+  if (!write(write_buffer, write_len, false))
+    return false;
+  if (!twi_start((_addr << 1) | 1)) {
+    twi_stop();
+    return false;
+  }
+  while (read_len--) {
+    twi_command(read_len ? _BV(TWEA) : 0); // NACK the last byte
+    *read_buffer++ = TWDR;
+  }
+  twi_stop();
+  return true;
+}
@@ -0,0 +1,23 @@
+/***************************************************
+  Size benchmark for the Adafruit PCA9685 PWM Servo Driver library, built by
+  size_report.sh with each configuration in turn. It touches the API a
+  typical servo or LED sketch uses so the linker keeps those paths.
+
+  BSD license, all text above must be included in any redistribution
+ ****************************************************/
+
+#include <Adafruit_PWMServoDriver.h>
+
+Adafruit_PWMServoDriver pwm = Adafruit_PWMServoDriver();
+
+void setup() {
+  pwm.begin();
+  pwm.setPWMFreq(50);
+}
+
+void loop() {
+  for (uint8_t num = 0; num < 16; num++) {
+    pwm.setPin(num, num * 256);
+    pwm.writeMicroseconds(num, 1000 + num * 64);
+  }
+}
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# Flash / RAM size report of the PCA9685 driver per build configuration.
+#
+# Builds size_report.ino for each board and configuration with arduino-cli
+# and prints the flash and RAM use reported by the AVR toolchain. Needs
+# arduino-cli with the arduino:avr core and the Adafruit BusIO library
+# installed, boards that are not installed are skipped.
+#
+#   extras/size_report/size_report.sh [fqbn ...]
+#
+
+set -e
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+LIBRARY=$(cd "$HERE/../.." && pwd)
+BOARDS=${*:-"arduino:avr:uno arduino:avr:diecimila:cpu=atmega168"}
+
+CONFIGS="default: \
+tiny:-DPCA9685_TINY \
+no_float:-DPCA9685_NO_FLOAT \
+no_trims:-DPCA9685_NO_TRIMS"
+
+if ! command -v arduino-cli >/dev/null 2>&1; then
+  echo "arduino-cli not found, cannot build the size report" >&2
+  exit 1
+fi
+
+printf "%-40s %-10s %8s %8s\n" board config flash ram
+for board in $BOARDS; do
+  for config in $CONFIGS; do
+    name=${config%%:*}
+    flags=${config#*:}
+    out=$(arduino-cli compile --fqbn "$board" --library "$LIBRARY" \
+      --build-property "compiler.cpp.extra_flags=$flags" \
+      "$HERE" 2>&1) || {
+      printf "%-40s %-10s %8s %8s\n" "$board" "$name" skipped -
+      continue
+    }
+    flash=$(echo "$out" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+    ram=$(echo "$out" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+    printf "%-40s %-10s %8s %8s\n" "$board" "$name" "$flash" "$ram"
+  done
+done